@@ -0,0 +1,750 @@
+// circlock_host.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Headless render harness: runs the face against host/pebble.h and reports
+// the cost of every update proc for the first frame and for simulated hours.
+//
+// usage: circlock-host [--start EPOCH] [--hours N] [--tap-every SECONDS]
+//                      [--events FILE] [--model SPEC] [--relaunch]
+//                      [--dump DIR] [--dump-every SECONDS] [--verbose]
+//                      [--config RADIUS,WIDTH,HEIGHT,MARGIN,INVERT]
+//                      [--bench-hands ROUNDS] [--bench-labels ROUNDS]
+//                      [--check-hands]
+//
+// --config sends the face configuration over AppMessage right after launch,
+// like the phone would.
+//
+// --relaunch exits the face after the simulated hours and launches it again
+// on the same persistent storage, to time a launch that finds the snapshot
+// of the previous session.
+//
+// --events replays taps, battery changes and focus changes at the given
+// seconds into the run, one per line:
+//
+//     600 tap
+//     3600 battery 80
+//     7200 battery 80 charging
+//     9000 focus out
+//
+// Every simulated hour is priced with the cost model of power_model.h, the
+// costs can be overridden with --model "idle=UW,wakeup=UJ,frame=UJ,draw=UJ,
+// pixel=UJ,battery=MWH". The last line of the report sums up the run for
+// the build flags it names, so builds can be compared with grep.
+//
+// --bench-hands fills every hand position ROUNDS times as a path with
+// gpath_draw_filled and as a ring sector with circlock_sector_fill, and
+// reports the time and the pixels covered per hand for both.
+//
+// --check-hands fills every position of the hand tables and the same hand
+// the way the face drew it before the tables existed, the unrotated GPathInfo
+// of its ring turned with gpath_rotate_to(), and fails if any two differ by
+// a pixel. With --config it checks the tables derived for that configuration.
+//
+// --bench-labels draws the time and date labels ROUNDS times with
+// graphics_draw_text and, in builds with CIRCLOCK_GLYPH_LABELS, with the
+// glyph atlas blitter. The stand-in graphics_draw_text does no real text
+// layout, so its time is a lower bound of the firmware's.
+
+#include "pebble_host.h"
+
+#include "circlock.h"
+#include "circlock_conf.h"
+#include "circlock_config.h"
+#include "circlock_geometry.h"
+#include "circlock_glyphs.h"
+#include "circlock_render.h"
+#include "circlock_sector.h"
+#include "power_model.h"
+
+// the harness allocates from the C library, the heap figures of the report
+// stay the face's own
+#undef calloc
+#undef free
+
+typedef enum {
+    EVENT_TAP,
+    EVENT_BATTERY,
+    EVENT_FOCUS,
+} EventType;
+
+typedef struct {
+    uint32_t second;
+    EventType type;
+    BatteryChargeState battery;
+    bool in_focus;
+} Event;
+
+typedef struct {
+    time_t start;
+    uint32_t hours;
+    uint32_t tap_every;
+    const char *dump_dir;
+    uint32_t dump_every;
+    bool verbose;
+    const char *config;
+    uint32_t bench_rounds;
+    uint32_t bench_label_rounds;
+    bool check_hands;
+    const char *events;
+    PowerModel model;
+    bool relaunch;
+} Options;
+
+static void usage()
+{
+    fprintf(stderr, "usage: circlock-host [--start EPOCH] [--hours N] [--tap-every SECONDS]\n"
+                    "                     [--events FILE] [--model SPEC] [--relaunch]\n"
+                    "                     [--dump DIR] [--dump-every SECONDS] [--verbose]\n"
+                    "                     [--config RADIUS,WIDTH,HEIGHT,MARGIN,INVERT]\n"
+                    "                     [--bench-hands ROUNDS] [--bench-labels ROUNDS]\n"
+                    "                     [--check-hands]\n");
+    exit(2);
+}
+
+static Options parse_options(int argc, char **argv)
+{
+    // 2014-10-11 12:00:17 UTC, outside the default quiet hours
+    Options options = { 1413028817, 1, 0, NULL, 0, false, NULL, 0, 0, false, NULL, power_model_default(), false };
+    int i;
+    for (i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--start") == 0 && has_value)
+        {
+            options.start = (time_t)strtoll(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--hours") == 0 && has_value)
+        {
+            options.hours = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--tap-every") == 0 && has_value)
+        {
+            options.tap_every = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--dump") == 0 && has_value)
+        {
+            options.dump_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dump-every") == 0 && has_value)
+        {
+            options.dump_every = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--config") == 0 && has_value)
+        {
+            options.config = argv[++i];
+        }
+        else if (strcmp(argv[i], "--bench-hands") == 0 && has_value)
+        {
+            options.bench_rounds = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--bench-labels") == 0 && has_value)
+        {
+            options.bench_label_rounds = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--check-hands") == 0)
+        {
+            options.check_hands = true;
+        }
+        else if (strcmp(argv[i], "--events") == 0 && has_value)
+        {
+            options.events = argv[++i];
+        }
+        else if (strcmp(argv[i], "--model") == 0 && has_value)
+        {
+            if (!power_model_parse(&options.model, argv[++i]))
+            {
+                usage();
+            }
+        }
+        else if (strcmp(argv[i], "--relaunch") == 0)
+        {
+            options.relaunch = true;
+        }
+        else if (strcmp(argv[i], "--verbose") == 0)
+        {
+            options.verbose = true;
+        }
+        else
+        {
+            usage();
+        }
+    }
+    return options;
+}
+
+static void send_config(const char *config)
+{
+    Tuple tuples[5];
+    const char *field = config;
+    size_t count;
+    for (count = 0; count < sizeof(tuples) / sizeof(tuples[0]) && *field; ++count)
+    {
+        char *end;
+        tuples[count].key = CIRCLOCK_CONFIG_KEY_CLOCK_RADIUS + count;
+        tuples[count].type = TUPLE_UINT;
+        tuples[count].length = 1;
+        tuples[count].value[0].uint8 = (uint8_t)strtoul(field, &end, 10);
+        if (end == field || (*end && *end != ','))
+        {
+            usage();
+        }
+        field = *end ? end + 1 : end;
+    }
+    pbl_host_app_message(tuples, count);
+}
+
+// reads the --events file, in the order the events are to be replayed
+static Event *load_events(const char *path, size_t *count)
+{
+    *count = 0;
+    if (!path)
+    {
+        return NULL;
+    }
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "circlock-host: cannot read %s\n", path);
+        exit(1);
+    }
+    Event *events = NULL;
+    size_t capacity = 0;
+    uint32_t previous = 0;
+    unsigned line_number = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), file))
+    {
+        ++line_number;
+        char type[16] = "", arg[16] = "", flag[16] = "";
+        unsigned second;
+        const int fields = sscanf(line, "%u %15s %15s %15s", &second, type, arg, flag);
+        if (fields <= 0 || line[strspn(line, " \t")] == '#')
+        {
+            continue;
+        }
+        Event event = { .second = second };
+        if (fields == 2 && strcmp(type, "tap") == 0)
+        {
+            event.type = EVENT_TAP;
+        }
+        else if (fields >= 3 && strcmp(type, "battery") == 0
+                 && (fields == 3 || strcmp(flag, "charging") == 0))
+        {
+            const bool charging = fields == 4;
+            event.type = EVENT_BATTERY;
+            event.battery = (BatteryChargeState){
+                .charge_percent = (uint8_t)atoi(arg),
+                .is_charging = charging,
+                .is_plugged = charging,
+            };
+        }
+        else if (fields == 3 && strcmp(type, "focus") == 0
+                 && (strcmp(arg, "in") == 0 || strcmp(arg, "out") == 0))
+        {
+            event.type = EVENT_FOCUS;
+            event.in_focus = strcmp(arg, "in") == 0;
+        }
+        else
+        {
+            fprintf(stderr, "circlock-host: %s:%u: cannot parse event\n", path, line_number);
+            exit(1);
+        }
+        if (event.second < previous)
+        {
+            fprintf(stderr, "circlock-host: %s:%u: events out of order\n", path, line_number);
+            exit(1);
+        }
+        previous = event.second;
+        if (*count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 16;
+            events = realloc(events, capacity * sizeof(Event));
+        }
+        events[(*count)++] = event;
+    }
+    fclose(file);
+    return events;
+}
+
+static void replay_event(const Event *event)
+{
+    switch (event->type)
+    {
+    case EVENT_TAP:
+        pbl_host_tap();
+        break;
+    case EVENT_BATTERY:
+        pbl_host_battery(event->battery);
+        break;
+    case EVENT_FOCUS:
+        pbl_host_focus(event->in_focus);
+        break;
+    }
+}
+
+static PblHostCounters counters_between(PblHostCounters from, PblHostCounters to)
+{
+    return (PblHostCounters){
+        .wakeups = to.wakeups - from.wakeups,
+        .frames = to.frames - from.frames,
+        .draw_calls = to.draw_calls - from.draw_calls,
+        .pixels = to.pixels - from.pixels,
+    };
+}
+
+static const char *build_flags(void)
+{
+    static char flags[200];
+    snprintf(flags, sizeof(flags),
+             "seconds=%d battery=%d date=%d sectors=%d compact=%d glyphs=%d diff=%d sweep=%d energy=%d trace=%d",
+             CIRCLOCK_FEATURE_SECONDS, CIRCLOCK_FEATURE_BATTERY, CIRCLOCK_FEATURE_DATE,
+             CIRCLOCK_HANDS_SECTORS, CIRCLOCK_COMPACT_RENDER, CIRCLOCK_GLYPH_LABELS,
+             CIRCLOCK_RENDER_DIFF, CIRCLOCK_SWEEP, CIRCLOCK_ENERGY, CIRCLOCK_TRACE);
+    return flags;
+}
+
+// Prices every simulated hour with the cost model, in millijoules. Pixels
+// drawn through the graphics calls count each time they are drawn, the ones
+// copied or filled straight into the frame buffer count when they changed.
+static void print_energy(const Options *options, const PblHostCounters *hours)
+{
+    power_model_print(&options->model);
+    printf("  %-5s %8s %8s %8s %10s %9s %9s %9s %9s %9s %10s\n", "hour", "wakeups", "frames",
+           "draws", "pixels", "idle mJ", "wake mJ", "frame mJ", "draw mJ", "pixel mJ", "total mJ");
+    PblHostCounters total = { 0 };
+    uint32_t h;
+    for (h = 0; h <= options->hours; ++h)
+    {
+        const bool is_total = h == options->hours;
+        const PblHostCounters *c = is_total ? &total : &hours[h];
+        const PowerEstimate e = power_model_estimate(&options->model, c, is_total ? h * 3600 : 3600);
+        char label[8];
+        if (is_total)
+        {
+            snprintf(label, sizeof(label), "total");
+        }
+        else
+        {
+            const time_t start = options->start + (time_t)h * 3600;
+            snprintf(label, sizeof(label), "%02d", localtime(&start)->tm_hour);
+            total.wakeups += c->wakeups;
+            total.frames += c->frames;
+            total.draw_calls += c->draw_calls;
+            total.pixels += c->pixels;
+        }
+        printf("  %-5s %8llu %8llu %8llu %10llu %9.1f %9.1f %9.1f %9.1f %9.1f %10.1f\n", label,
+               (unsigned long long)c->wakeups, (unsigned long long)c->frames,
+               (unsigned long long)c->draw_calls, (unsigned long long)c->pixels,
+               e.idle_uj / 1000, e.wakeup_uj / 1000, e.frame_uj / 1000,
+               e.draw_call_uj / 1000, e.pixel_uj / 1000, power_estimate_total(&e) / 1000);
+    }
+    const PowerEstimate e = power_model_estimate(&options->model, &total, options->hours * 3600);
+    const double mwh = power_estimate_total(&e) / 3.6e6;
+    const double active_mwh = (power_estimate_total(&e) - e.idle_uj) / 3.6e6;
+    printf("energy [%s]: %.2f mWh in %u h, %.3f mWh above idle, %.1f%% of the battery per day\n\n", build_flags(),
+           mwh, (unsigned)options->hours, active_mwh,
+           options->hours ? mwh * 24 / options->hours / options->model.battery_mwh * 100 : 0.0);
+}
+
+static void print_report(const char *title)
+{
+    size_t count;
+    const PblHostProcStats *stats = pbl_host_proc_stats(&count);
+    const PblHostCounters counters = pbl_host_counters();
+
+    printf("%s\n", title);
+    printf("  %-28s %8s %12s %10s %10s %12s\n", "update proc", "calls", "total us", "us/call", "draws", "pixels");
+    size_t i;
+    for (i = 0; i < count; ++i)
+    {
+        const PblHostProcStats *s = &stats[i];
+        printf("  %-28s %8llu %12.1f %10.2f %10llu %12llu\n", s->name,
+               (unsigned long long)s->calls, s->nanos / 1000.0,
+               s->calls ? s->nanos / 1000.0 / s->calls : 0.0,
+               (unsigned long long)s->draw_calls, (unsigned long long)s->pixels);
+    }
+    printf("  wakeups %llu, frames %llu, draw calls %llu, pixels %llu, heap %zu bytes, persist %zu bytes\n",
+           (unsigned long long)counters.wakeups, (unsigned long long)counters.frames,
+           (unsigned long long)counters.draw_calls, (unsigned long long)counters.pixels,
+           heap_bytes_used(), pbl_host_persist_bytes_used());
+    // counted by the face since launch, the first frame included
+    const CirclockRenderStats *render = circlock_render_stats();
+    printf("  frames drawn %u, skipped %u; hands drawn %u, skipped %u; battery drawn %u, skipped %u\n\n",
+           (unsigned)render->frames_drawn, (unsigned)render->frames_skipped,
+           (unsigned)render->parts_drawn[CIRCLOCK_RENDER_HANDS],
+           (unsigned)render->parts_skipped[CIRCLOCK_RENDER_HANDS],
+           (unsigned)render->parts_drawn[CIRCLOCK_RENDER_BATTERY],
+           (unsigned)render->parts_skipped[CIRCLOCK_RENDER_BATTERY]);
+}
+
+static void dump_frame(const Options *options, uint32_t second)
+{
+    if (!options->dump_dir)
+    {
+        return;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame-%06u.pbm", options->dump_dir, (unsigned)second);
+    if (!pbl_host_dump_pbm(path))
+    {
+        fprintf(stderr, "circlock-host: cannot write %s\n", path);
+        exit(1);
+    }
+}
+
+static const char *UNIT_NAMES[] = { "second", "minute", "hour", "wday", "mday" };
+
+static uint64_t bench_nanos(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// fills one hand in black, on white when clear is set, and returns the
+// number of black pixels
+static uint32_t bench_fill(Layer *layer, uint8_t ring, uint8_t step, bool sector, bool clear)
+{
+    GContext *ctx = pbl_host_screen_context();
+    const GPoint center = circlock_geometry()->layout.center;
+    const CirclockHandPoints *table = circlock_geometry()->hands[ring];
+    GPoint points[CIRCLOCK_HAND_POINTS];
+    int16_t min_y = INT16_MAX, max_y = INT16_MIN;
+    uint8_t i;
+    for (i = 0; i < CIRCLOCK_HAND_POINTS; ++i)
+    {
+        points[i] = GPoint(center.x + table[step][i][0], center.y + table[step][i][1]);
+        min_y = points[i].y < min_y ? points[i].y : min_y;
+        max_y = points[i].y > max_y ? points[i].y : max_y;
+    }
+    if (clear)
+    {
+        GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+        memset(gbitmap_get_data(frame_buffer), 0xff,
+               gbitmap_get_bytes_per_row(frame_buffer) * gbitmap_get_bounds(frame_buffer).size.h);
+        graphics_release_frame_buffer(ctx, frame_buffer);
+    }
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    if (sector)
+    {
+        GBitmap *frame_buffer = circlock_sector_begin(layer, ctx);
+        circlock_sector_fill(frame_buffer, center, ring, circlock_geometry_ring_angle(ring, step),
+                             GRect(0, min_y - 1, PBL_HOST_SCREEN_WIDTH, max_y - min_y + 3), GColorBlack);
+        circlock_sector_end(ctx, frame_buffer);
+    }
+    else
+    {
+        GPath path = { CIRCLOCK_HAND_POINTS, points, 0, GPointZero };
+        gpath_draw_filled(ctx, &path);
+    }
+    if (!clear)
+    {
+        return 0;
+    }
+    const uint8_t *data = pbl_host_frame_buffer();
+    uint32_t black = 0;
+    size_t k;
+    for (k = 0; k < PBL_HOST_SCREEN_HEIGHT * PBL_HOST_SCREEN_WIDTH / 8; ++k)
+    {
+        black += 8 - __builtin_popcount(data[k]);
+    }
+    return black;
+}
+
+// benchmarks the geometry the face would use, the tables in flash unless a
+// configuration is given
+static void bench_hands(uint32_t rounds, const char *config)
+{
+    if (config)
+    {
+        circlock_config_init(NULL);
+        send_config(config);
+    }
+    const CirclockConfig default_config = circlock_geometry_default_config();
+    circlock_geometry_init(GSize(PBL_HOST_SCREEN_WIDTH, PBL_HOST_SCREEN_HEIGHT),
+                           config ? circlock_config() : &default_config);
+    Layer *layer = layer_create(GRect(0, 0, PBL_HOST_SCREEN_WIDTH, PBL_HOST_SCREEN_HEIGHT));
+    printf("hand fill, %u rounds over every position\n", (unsigned)rounds);
+    printf("  %-8s %-8s %10s %10s\n", "hand", "fill", "ns/hand", "px/hand");
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        const uint8_t steps = circlock_rings[ring].steps;
+        int sector;
+        for (sector = 0; sector <= 1; ++sector)
+        {
+            uint64_t pixels = 0;
+            uint8_t step;
+            for (step = 0; step < steps; ++step)
+            {
+                pixels += bench_fill(layer, ring, step, sector, true);
+            }
+            const uint64_t accounted = pbl_host_accounting_nanos();
+            const uint64_t start = bench_nanos();
+            uint32_t round;
+            for (round = 0; round < rounds; ++round)
+            {
+                for (step = 0; step < steps; ++step)
+                {
+                    bench_fill(layer, ring, step, sector, false);
+                }
+            }
+            const uint64_t nanos = bench_nanos() - start - (pbl_host_accounting_nanos() - accounted);
+            const uint64_t fills = (uint64_t)rounds * steps;
+            printf("  %-8s %-8s %10.1f %10.1f\n", UNIT_NAMES[circlock_rings[ring].unit], sector ? "sector" : "gpath",
+                   fills ? (double)nanos / fills : 0.0, (double)pixels / steps);
+        }
+    }
+    layer_destroy(layer);
+    circlock_geometry_deinit();
+    if (config)
+    {
+        circlock_config_deinit();
+    }
+}
+
+// fills the hand of a ring at a step on white the way the face did before
+// the hand tables, from the unrotated path of the ring
+static void fill_rotated_hand(uint8_t ring, uint8_t step)
+{
+    GContext *ctx = pbl_host_screen_context();
+    const CirclockConfig *config = &circlock_geometry()->config;
+    const int16_t half = config->hand_width / 2;
+    const int16_t point_y = config->clock_radius + config->hand_margin - ring * (config->hand_height + config->hand_margin);
+    const int16_t outer = point_y + config->hand_margin;
+    const int16_t inner = point_y - config->hand_height - config->hand_margin;
+    GPoint points[] = { { -half, outer }, { half, outer }, { half, inner }, { -half, inner } };
+    const GPathInfo info = { sizeof(points) / sizeof(points[0]), points };
+
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    memset(gbitmap_get_data(frame_buffer), 0xff,
+           gbitmap_get_bytes_per_row(frame_buffer) * gbitmap_get_bounds(frame_buffer).size.h);
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    GPath *path = gpath_create(&info);
+    gpath_rotate_to(path, circlock_geometry_ring_angle(ring, step));
+    gpath_move_to(path, circlock_geometry()->layout.center);
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    gpath_draw_filled(ctx, path);
+    gpath_destroy(path);
+}
+
+// checks the hand tables the face would use against gpath_rotate_to(), the
+// tables in flash unless a configuration is given, and returns whether
+// every position matched
+static bool check_hands(const char *config)
+{
+    if (config)
+    {
+        circlock_config_init(NULL);
+        send_config(config);
+    }
+    const CirclockConfig default_config = circlock_geometry_default_config();
+    circlock_geometry_init(GSize(PBL_HOST_SCREEN_WIDTH, PBL_HOST_SCREEN_HEIGHT),
+                           config ? circlock_config() : &default_config);
+    Layer *layer = layer_create(GRect(0, 0, PBL_HOST_SCREEN_WIDTH, PBL_HOST_SCREEN_HEIGHT));
+    static uint8_t table_frame[PBL_HOST_SCREEN_HEIGHT * PBL_HOST_SCREEN_WIDTH / 8];
+    printf("hand tables against gpath_rotate_to\n");
+    printf("  %-8s %10s %10s\n", "hand", "positions", "differ");
+    uint32_t differ_total = 0;
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        const uint8_t steps = circlock_rings[ring].steps;
+        uint32_t differ = 0;
+        uint8_t step;
+        for (step = 0; step < steps; ++step)
+        {
+            bench_fill(layer, ring, step, false, true);
+            memcpy(table_frame, pbl_host_frame_buffer(), sizeof(table_frame));
+            fill_rotated_hand(ring, step);
+            if (memcmp(table_frame, pbl_host_frame_buffer(), sizeof(table_frame)) != 0)
+            {
+                if (differ == 0)
+                {
+                    printf("  %s step %u differs first\n", UNIT_NAMES[circlock_rings[ring].unit], (unsigned)step);
+                }
+                ++differ;
+            }
+        }
+        printf("  %-8s %10u %10u\n", UNIT_NAMES[circlock_rings[ring].unit], (unsigned)steps, (unsigned)differ);
+        differ_total += differ;
+    }
+    layer_destroy(layer);
+    circlock_geometry_deinit();
+    if (config)
+    {
+        circlock_config_deinit();
+    }
+    return differ_total == 0;
+}
+
+typedef struct {
+    const char *name;
+    const char *text;
+    CirclockGlyphFont glyphs;
+    const char *font;
+} BenchLabel;
+
+// the widest strings the labels show
+static const BenchLabel BENCH_LABELS[] = {
+    { "time", "12:58PM", CIRCLOCK_GLYPHS_TIME, FONT_KEY_GOTHIC_18 },
+    { "date", "Wed, May 28", CIRCLOCK_GLYPHS_DATE, FONT_KEY_GOTHIC_14 },
+};
+
+static void bench_labels(uint32_t rounds)
+{
+    const CirclockConfig config = circlock_geometry_default_config();
+    circlock_geometry_init(GSize(PBL_HOST_SCREEN_WIDTH, PBL_HOST_SCREEN_HEIGHT), &config);
+    const CirclockLayout *layout = &circlock_geometry()->layout;
+    Layer *layer = layer_create(GRect(0, 0, PBL_HOST_SCREEN_WIDTH, PBL_HOST_SCREEN_HEIGHT));
+    GContext *ctx = pbl_host_screen_context();
+    printf("label drawing, %u rounds\n", (unsigned)rounds);
+    printf("  %-8s %-8s %10s\n", "label", "draw", "ns/label");
+    size_t l;
+    for (l = 0; l < sizeof(BENCH_LABELS) / sizeof(BENCH_LABELS[0]); ++l)
+    {
+        const BenchLabel *label = &BENCH_LABELS[l];
+        const GRect rect = label->glyphs == CIRCLOCK_GLYPHS_TIME ? layout->time_rect : layout->date_rect;
+        const GFont font = fonts_get_system_font(label->font);
+        int glyphs;
+        for (glyphs = 0; glyphs <= CIRCLOCK_GLYPH_LABELS; ++glyphs)
+        {
+            const uint64_t accounted = pbl_host_accounting_nanos();
+            const uint64_t start = bench_nanos();
+            uint32_t round;
+            for (round = 0; round < rounds; ++round)
+            {
+                if (glyphs)
+                {
+#if CIRCLOCK_GLYPH_LABELS
+                    circlock_glyphs_draw(layer, ctx, label->glyphs, label->text, rect, GColorWhite);
+#endif
+                }
+                else
+                {
+                    graphics_context_set_text_color(ctx, GColorWhite);
+                    graphics_draw_text(ctx, label->text, font, rect, GTextOverflowModeWordWrap,
+                                       GTextAlignmentCenter, NULL);
+                }
+            }
+            const uint64_t nanos = bench_nanos() - start - (pbl_host_accounting_nanos() - accounted);
+            printf("  %-8s %-8s %10.1f\n", label->name, glyphs ? "glyphs" : "text",
+                   rounds ? (double)nanos / rounds : 0.0);
+        }
+    }
+    layer_destroy(layer);
+    circlock_geometry_deinit();
+}
+
+// Launches the face and reports its first frame, with the wall time from the
+// launch until the frame is on screen and until the face has been drawn. A
+// face that starts up behind a snapshot draws itself from a timer.
+static void launch(const char *config, const char *title)
+{
+    const uint64_t accounted = pbl_host_accounting_nanos();
+    const uint64_t start = bench_nanos();
+    circlock_init();
+    if (config)
+    {
+        send_config(config);
+    }
+    pbl_host_render();
+    const uint64_t first_frame = bench_nanos() - start - (pbl_host_accounting_nanos() - accounted);
+    pbl_host_advance(1);
+    const uint64_t face = bench_nanos() - start - (pbl_host_accounting_nanos() - accounted);
+    print_report(title);
+    printf("  first frame after %.1f us, face drawn after %.1f us\n\n", first_frame / 1000.0, face / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    const Options options = parse_options(argc, argv);
+    pbl_host_reset(options.start);
+    pbl_host_set_logging(options.verbose);
+    if (options.bench_rounds)
+    {
+        bench_hands(options.bench_rounds, options.config);
+    }
+    if (options.bench_label_rounds)
+    {
+        bench_labels(options.bench_label_rounds);
+    }
+    if (options.check_hands && !check_hands(options.config))
+    {
+        return 1;
+    }
+    if (options.bench_rounds || options.bench_label_rounds || options.check_hands)
+    {
+        return 0;
+    }
+
+    launch(options.config, "first frame");
+    dump_frame(&options, 0);
+
+    size_t event_count;
+    Event *events = load_events(options.events, &event_count);
+    size_t next_event = 0;
+    PblHostCounters *hours = calloc(options.hours ? options.hours : 1, sizeof(PblHostCounters));
+    PblHostCounters hour_start = { 0 };
+
+    pbl_host_reset_stats();
+    const uint32_t seconds = options.hours * 3600;
+    uint32_t second;
+    for (second = 1; second <= seconds; ++second)
+    {
+        if (options.tap_every && second % options.tap_every == 0)
+        {
+            pbl_host_tap();
+        }
+        while (next_event < event_count && events[next_event].second <= second)
+        {
+            replay_event(&events[next_event++]);
+        }
+        pbl_host_advance(1000);
+        if (options.dump_every && second % options.dump_every == 0)
+        {
+            dump_frame(&options, second);
+        }
+        if (second % 3600 == 0)
+        {
+            const PblHostCounters counters = pbl_host_counters();
+            hours[second / 3600 - 1] = counters_between(hour_start, counters);
+            hour_start = counters;
+        }
+    }
+    char title[64];
+    snprintf(title, sizeof(title), "%u simulated hour(s)", (unsigned)options.hours);
+    print_report(title);
+    print_energy(&options, hours);
+    free(hours);
+    free(events);
+
+    if (options.relaunch)
+    {
+        circlock_deinit();
+        pbl_host_reset_stats();
+        launch(NULL, "relaunch");
+    }
+
+    circlock_deinit();
+    return 0;
+}
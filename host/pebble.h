@@ -0,0 +1,347 @@
+// pebble.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Host stand-in for the subset of the Pebble SDK used by src/*.c.
+// Drawing rasterizes into a 144x168 1-bit memory framebuffer laid out like
+// the aplite display, and every call is accounted to the update proc that
+// is currently running (see pebble_host.h).
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// time
+
+#define time(t) pbl_host_time(t)
+extern time_t pbl_host_time(time_t *);
+extern uint16_t time_ms(time_t *, uint16_t *);
+
+typedef enum {
+    SECOND_UNIT = 1 << 0,
+    MINUTE_UNIT = 1 << 1,
+    HOUR_UNIT = 1 << 2,
+    DAY_UNIT = 1 << 3,
+    MONTH_UNIT = 1 << 4,
+    YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *, TimeUnits);
+extern void tick_timer_service_subscribe(TimeUnits, TickHandler);
+extern void tick_timer_service_unsubscribe(void);
+
+// logging
+
+#define APP_LOG_LEVEL_ERROR 1
+#define APP_LOG_LEVEL_WARNING 50
+#define APP_LOG_LEVEL_INFO 100
+#define APP_LOG_LEVEL_DEBUG 200
+#define APP_LOG(level, ...) pbl_host_log(level, __FILE__, __LINE__, __VA_ARGS__)
+extern void pbl_host_log(int, const char *, int, const char *, ...);
+
+// memory
+
+#define malloc(size) pbl_host_malloc(size)
+#define calloc(count, size) pbl_host_calloc(count, size)
+#define free(ptr) pbl_host_free(ptr)
+extern void *pbl_host_malloc(size_t);
+extern void *pbl_host_calloc(size_t, size_t);
+extern void pbl_host_free(void *);
+extern size_t heap_bytes_used(void);
+extern size_t heap_bytes_free(void);
+
+// geometry
+
+typedef struct GPoint {
+    int16_t x;
+    int16_t y;
+} GPoint;
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GPointZero GPoint(0, 0)
+
+typedef struct GSize {
+    int16_t w;
+    int16_t h;
+} GSize;
+#define GSize(w, h) ((GSize){(w), (h)})
+
+typedef struct GRect {
+    GPoint origin;
+    GSize size;
+} GRect;
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GRectZero GRect(0, 0, 0, 0)
+
+extern GPoint grect_center_point(const GRect *);
+
+typedef enum GColor {
+    GColorClear = ~0,
+    GColorBlack = 0,
+    GColorWhite = 1,
+} GColor;
+
+typedef enum {
+    GCornerNone = 0,
+    GCornerTopLeft = 1 << 0,
+    GCornerTopRight = 1 << 1,
+    GCornerBottomLeft = 1 << 2,
+    GCornerBottomRight = 1 << 3,
+    GCornersAll = 0xf,
+} GCornerMask;
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+extern int32_t sin_lookup(int32_t);
+extern int32_t cos_lookup(int32_t);
+
+// graphics
+
+typedef struct GContext GContext;
+
+typedef enum {
+    GBitmapFormat1Bit = 0,
+    GBitmapFormat8Bit,
+} GBitmapFormat;
+
+typedef struct GBitmap GBitmap;
+extern GBitmap *gbitmap_create_blank(GSize, GBitmapFormat);
+extern void gbitmap_destroy(GBitmap *);
+extern uint8_t *gbitmap_get_data(const GBitmap *);
+extern uint16_t gbitmap_get_bytes_per_row(const GBitmap *);
+extern GBitmapFormat gbitmap_get_format(const GBitmap *);
+extern GRect gbitmap_get_bounds(const GBitmap *);
+
+extern GBitmap *graphics_capture_frame_buffer(GContext *);
+extern bool graphics_release_frame_buffer(GContext *, GBitmap *);
+
+extern void graphics_context_set_fill_color(GContext *, GColor);
+extern void graphics_context_set_stroke_color(GContext *, GColor);
+extern void graphics_context_set_text_color(GContext *, GColor);
+extern void graphics_fill_rect(GContext *, GRect, uint16_t, GCornerMask);
+extern void graphics_fill_circle(GContext *, GPoint, uint16_t);
+extern void graphics_draw_line(GContext *, GPoint, GPoint);
+extern void graphics_draw_bitmap_in_rect(GContext *, const GBitmap *, GRect);
+
+typedef struct GPathInfo {
+    uint32_t num_points;
+    GPoint *points;
+} GPathInfo;
+
+typedef struct GPath {
+    uint32_t num_points;
+    GPoint *points;
+    int32_t rotation;
+    GPoint offset;
+} GPath;
+
+extern GPath *gpath_create(const GPathInfo *);
+extern void gpath_destroy(GPath *);
+extern void gpath_rotate_to(GPath *, int32_t);
+extern void gpath_move_to(GPath *, GPoint);
+extern void gpath_draw_filled(GContext *, GPath *);
+extern void gpath_draw_outline(GContext *, GPath *);
+
+// fonts and text
+
+typedef struct PblHostFont *GFont;
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+extern GFont fonts_get_system_font(const char *);
+
+typedef enum {
+    GTextAlignmentLeft,
+    GTextAlignmentCenter,
+    GTextAlignmentRight,
+} GTextAlignment;
+
+typedef enum {
+    GTextOverflowModeWordWrap,
+    GTextOverflowModeTrailingEllipsis,
+    GTextOverflowModeFill,
+} GTextOverflowMode;
+
+extern void graphics_draw_text(GContext *, const char *, GFont, GRect, GTextOverflowMode, GTextAlignment, void *);
+
+// layers and windows
+
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(Layer *, GContext *);
+
+extern Layer *layer_create(GRect);
+extern void layer_destroy(Layer *);
+// the proc name is recorded for the harness report
+#define PBL_HOST_STRINGIFY(x) #x
+#define layer_set_update_proc(layer, proc) pbl_host_layer_set_update_proc((layer), (proc), PBL_HOST_STRINGIFY(proc))
+extern void pbl_host_layer_set_update_proc(Layer *, LayerUpdateProc, const char *);
+extern void layer_add_child(Layer *, Layer *);
+extern void layer_remove_from_parent(Layer *);
+extern void layer_mark_dirty(Layer *);
+extern GRect layer_get_bounds(const Layer *);
+extern GRect layer_get_frame(const Layer *);
+extern void layer_set_frame(Layer *, GRect);
+extern void layer_set_hidden(Layer *, bool);
+
+typedef struct TextLayer TextLayer;
+extern TextLayer *text_layer_create(GRect);
+extern void text_layer_destroy(TextLayer *);
+extern Layer *text_layer_get_layer(TextLayer *);
+extern void text_layer_set_text(TextLayer *, const char *);
+extern void text_layer_set_background_color(TextLayer *, GColor);
+extern void text_layer_set_text_color(TextLayer *, GColor);
+extern void text_layer_set_font(TextLayer *, GFont);
+extern void text_layer_set_text_alignment(TextLayer *, GTextAlignment);
+
+typedef struct Window Window;
+typedef void (*WindowHandler)(Window *);
+typedef struct WindowHandlers {
+    WindowHandler load;
+    WindowHandler appear;
+    WindowHandler disappear;
+    WindowHandler unload;
+} WindowHandlers;
+
+extern Window *window_create(void);
+extern void window_destroy(Window *);
+extern void window_set_window_handlers(Window *, WindowHandlers);
+extern Layer *window_get_root_layer(const Window *);
+extern void window_set_background_color(Window *, GColor);
+extern void window_stack_push(Window *, bool);
+
+// services
+
+typedef struct BatteryChargeState {
+    uint8_t charge_percent;
+    bool is_charging;
+    bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState);
+extern BatteryChargeState battery_state_service_peek(void);
+extern void battery_state_service_subscribe(BatteryStateHandler);
+extern void battery_state_service_unsubscribe(void);
+
+typedef enum {
+    ACCEL_AXIS_X = 0,
+    ACCEL_AXIS_Y = 1,
+    ACCEL_AXIS_Z = 2,
+} AccelAxisType;
+
+typedef void (*AccelTapHandler)(AccelAxisType, int32_t);
+extern void accel_tap_service_subscribe(AccelTapHandler);
+extern void accel_tap_service_unsubscribe(void);
+
+typedef void (*AppFocusHandler)(bool);
+extern void app_focus_service_subscribe(AppFocusHandler);
+extern void app_focus_service_unsubscribe(void);
+
+typedef enum {
+    DATA_LOGGING_BYTE_ARRAY = 0,
+    DATA_LOGGING_UINT = 2,
+    DATA_LOGGING_INT = 3,
+} DataLoggingItemType;
+
+typedef enum {
+    DATA_LOGGING_SUCCESS = 0,
+    DATA_LOGGING_BUSY,
+    DATA_LOGGING_FULL,
+    DATA_LOGGING_NOT_FOUND,
+    DATA_LOGGING_CLOSED,
+    DATA_LOGGING_INVALID_PARAMS,
+} DataLoggingResult;
+
+typedef struct DataLoggingSession *DataLoggingSessionRef;
+extern DataLoggingSessionRef data_logging_create(uint32_t, DataLoggingItemType, uint16_t, bool);
+extern DataLoggingResult data_logging_log(DataLoggingSessionRef, const void *, uint32_t);
+extern void data_logging_finish(DataLoggingSessionRef);
+
+// persistent storage
+
+typedef int32_t status_t;
+typedef enum {
+    S_SUCCESS = 0,
+    E_ERROR = -1,
+    E_INVALID_ARGUMENT = -4,
+    E_OUT_OF_STORAGE = -6,
+    E_DOES_NOT_EXIST = -9,
+} StatusCode;
+
+#define PERSIST_DATA_MAX_LENGTH 256
+extern bool persist_exists(const uint32_t);
+extern int persist_read_data(const uint32_t, void *, const size_t);
+extern int persist_write_data(const uint32_t, const void *, const size_t);
+extern status_t persist_delete(const uint32_t);
+
+// app messages
+
+typedef enum {
+    TUPLE_BYTE_ARRAY = 0,
+    TUPLE_CSTRING = 1,
+    TUPLE_UINT = 2,
+    TUPLE_INT = 3,
+} TupleType;
+
+typedef struct Tuple {
+    uint32_t key;
+    TupleType type;
+    uint16_t length;
+    union {
+        uint8_t data[4];
+        char cstring[4];
+        uint8_t uint8;
+        uint16_t uint16;
+        uint32_t uint32;
+        int8_t int8;
+        int16_t int16;
+        int32_t int32;
+    } value[1];
+} Tuple;
+
+typedef struct DictionaryIterator {
+    Tuple *tuples;
+    size_t count;
+} DictionaryIterator;
+
+extern Tuple *dict_find(const DictionaryIterator *, const uint32_t);
+
+typedef enum {
+    APP_MSG_OK = 0,
+    APP_MSG_BUSY = 1 << 6,
+    APP_MSG_OUT_OF_MEMORY = 1 << 10,
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *, void *);
+extern AppMessageResult app_message_open(const uint32_t, const uint32_t);
+extern AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived);
+extern void app_message_deregister_callbacks(void);
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *);
+extern AppTimer *app_timer_register(uint32_t, AppTimerCallback, void *);
+extern bool app_timer_reschedule(AppTimer *, uint32_t);
+extern void app_timer_cancel(AppTimer *);
+
+extern void app_event_loop(void);
@@ -0,0 +1,1364 @@
+// pebble_host.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "pebble_host.h"
+#include "pebble_trig_table.h"
+
+#include <math.h>
+#include <stdarg.h>
+
+#undef time
+#undef malloc
+#undef calloc
+#undef free
+
+#define SCREEN_W PBL_HOST_SCREEN_WIDTH
+#define SCREEN_H PBL_HOST_SCREEN_HEIGHT
+#define SCREEN_ROW_BYTES 20
+
+#define MAX_CHILDREN 16
+#define MAX_TIMERS 16
+#define MAX_PERSIST_KEYS 64
+#define PERSIST_STORAGE_BYTES 4096
+
+struct Layer {
+    GRect frame;
+    bool hidden;
+    bool is_text;
+    LayerUpdateProc update_proc;
+    PblHostProcStats *stats;
+    Layer *parent;
+    Layer *children[MAX_CHILDREN];
+    size_t num_children;
+};
+
+struct TextLayer {
+    Layer layer;
+    const char *text;
+    GColor background;
+    GColor foreground;
+    GFont font;
+    GTextAlignment alignment;
+};
+
+struct Window {
+    Layer root;
+    WindowHandlers handlers;
+    GColor background;
+};
+
+struct GBitmap {
+    GBitmapFormat format;
+    uint16_t row_bytes;
+    GRect bounds;
+    uint8_t *data;
+};
+
+struct GContext {
+    GColor fill;
+    GColor stroke;
+    GColor text;
+    GPoint offset;
+    GRect clip;
+    bool captured;
+};
+
+struct PblHostFont {
+    int16_t height;
+};
+
+struct AppTimer {
+    bool active;
+    uint64_t due_ms;
+    AppTimerCallback callback;
+    void *data;
+};
+
+static uint8_t frame_buffer[SCREEN_ROW_BYTES * SCREEN_H];
+static GBitmap frame_bitmap = {
+    .format = GBitmapFormat1Bit,
+    .row_bytes = SCREEN_ROW_BYTES,
+    .bounds = {{0, 0}, {SCREEN_W, SCREEN_H}},
+    .data = frame_buffer,
+};
+static GContext context;
+
+// the frame buffer as it was captured, what changed until its release is
+// counted as pixels written, and the time spent counting is kept out of
+// the update procs' times
+static uint8_t captured_frame[SCREEN_ROW_BYTES * SCREEN_H];
+static uint64_t accounting_nanos;
+
+static uint64_t now_ms;
+static bool logging = true;
+static size_t heap_used;
+
+static Window *top_window;
+static bool tree_dirty;
+
+static TickHandler tick_handler;
+static TimeUnits tick_units;
+static BatteryStateHandler battery_handler;
+static BatteryChargeState battery_state = { 100, false, false };
+static AccelTapHandler tap_handler;
+static AppFocusHandler focus_handler;
+static struct AppTimer timers[MAX_TIMERS];
+
+static PblHostProcStats proc_stats[PBL_HOST_MAX_PROCS];
+static size_t num_proc_stats;
+static PblHostProcStats *current_stats;
+static PblHostCounters counters;
+
+static struct PblHostFont gothic_14 = { 14 };
+static struct PblHostFont gothic_18 = { 18 };
+
+// memory
+
+typedef struct {
+    size_t size;
+    long double align;
+} Allocation;
+
+__attribute__((noinline)) void *pbl_host_malloc(size_t size)
+{
+    Allocation *a = malloc(sizeof(Allocation) + size);
+    if (!a)
+    {
+        return NULL;
+    }
+    a->size = size;
+    heap_used += size;
+    return a + 1;
+}
+
+void *pbl_host_calloc(size_t count, size_t size)
+{
+    void *ptr = pbl_host_malloc(count * size);
+    if (ptr)
+    {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void pbl_host_free(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    Allocation *a = (Allocation *)ptr - 1;
+    heap_used -= a->size;
+    free(a);
+}
+
+size_t heap_bytes_used(void)
+{
+    return heap_used;
+}
+
+size_t heap_bytes_free(void)
+{
+    const size_t heap_size = 24 * 1024;
+    return heap_used < heap_size ? heap_size - heap_used : 0;
+}
+
+// time
+
+time_t pbl_host_time(time_t *t)
+{
+    const time_t now = (time_t)(now_ms / 1000);
+    if (t)
+    {
+        *t = now;
+    }
+    return now;
+}
+
+uint16_t time_ms(time_t *t, uint16_t *ms)
+{
+    pbl_host_time(t);
+    const uint16_t millis = (uint16_t)(now_ms % 1000);
+    if (ms)
+    {
+        *ms = millis;
+    }
+    return millis;
+}
+
+static uint64_t monotonic_nanos(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void pbl_host_log(int level, const char *file, int line, const char *fmt, ...)
+{
+    if (!logging)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%d] %s:%d ", level, file, line);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+// trig
+
+// the first quadrant from the table of tools/gen_trig_table.py, folded onto
+// the others the way the firmware does it
+int32_t sin_lookup(int32_t angle)
+{
+    int32_t sign = 1;
+    if (angle < 0)
+    {
+        angle = -angle;
+        sign = -sign;
+    }
+    angle %= TRIG_MAX_ANGLE;
+    if (angle >= TRIG_MAX_ANGLE / 2)
+    {
+        angle -= TRIG_MAX_ANGLE / 2;
+        sign = -sign;
+    }
+    if (angle > TRIG_MAX_ANGLE / 4)
+    {
+        angle = TRIG_MAX_ANGLE / 2 - angle;
+    }
+    return sign * SIN_QUARTER[angle];
+}
+
+int32_t cos_lookup(int32_t angle)
+{
+    return sin_lookup(angle + TRIG_MAX_ANGLE / 4);
+}
+
+// rasterizer
+
+static void count_pixels(uint64_t pixels)
+{
+    counters.pixels += pixels;
+    if (current_stats)
+    {
+        current_stats->pixels += pixels;
+    }
+}
+
+static void count_draw_call(void)
+{
+    counters.draw_calls++;
+    if (current_stats)
+    {
+        current_stats->draw_calls++;
+    }
+}
+
+static void put_pixel(GContext *ctx, int x, int y, GColor color)
+{
+    if (color == GColorClear)
+    {
+        return;
+    }
+    x += ctx->offset.x;
+    y += ctx->offset.y;
+    if (x < ctx->clip.origin.x || x >= ctx->clip.origin.x + ctx->clip.size.w ||
+        y < ctx->clip.origin.y || y >= ctx->clip.origin.y + ctx->clip.size.h)
+    {
+        return;
+    }
+    uint8_t *byte = &frame_buffer[y * SCREEN_ROW_BYTES + x / 8];
+    const uint8_t bit = (uint8_t)(1 << (x % 8));
+    *byte = color == GColorWhite ? (*byte | bit) : (*byte & ~bit);
+    count_pixels(1);
+}
+
+static void fill_span(GContext *ctx, int y, int x0, int x1, GColor color)
+{
+    for (int x = x0; x <= x1; ++x)
+    {
+        put_pixel(ctx, x, y, color);
+    }
+}
+
+GPoint grect_center_point(const GRect *rect)
+{
+    return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2);
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color)
+{
+    ctx->fill = color;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color)
+{
+    ctx->stroke = color;
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color)
+{
+    ctx->text = color;
+}
+
+static bool outside_corner(int dx, int dy, int radius)
+{
+    return dx * dx + dy * dy > radius * radius;
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t radius, GCornerMask corners)
+{
+    count_draw_call();
+    const int r = corners == GCornerNone ? 0 : radius;
+    for (int y = 0; y < rect.size.h; ++y)
+    {
+        for (int x = 0; x < rect.size.w; ++x)
+        {
+            const int left = r - 1 - x;
+            const int right = x - (rect.size.w - r);
+            const int top = r - 1 - y;
+            const int bottom = y - (rect.size.h - r);
+            if (r > 0 &&
+                (((corners & GCornerTopLeft) && left >= 0 && top >= 0 && outside_corner(left, top, r)) ||
+                 ((corners & GCornerTopRight) && right >= 0 && top >= 0 && outside_corner(right, top, r)) ||
+                 ((corners & GCornerBottomLeft) && left >= 0 && bottom >= 0 && outside_corner(left, bottom, r)) ||
+                 ((corners & GCornerBottomRight) && right >= 0 && bottom >= 0 && outside_corner(right, bottom, r))))
+            {
+                continue;
+            }
+            put_pixel(ctx, rect.origin.x + x, rect.origin.y + y, ctx->fill);
+        }
+    }
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint center, uint16_t radius)
+{
+    count_draw_call();
+    const int r = radius;
+    for (int dy = -r; dy <= r; ++dy)
+    {
+        const int dx = (int)floor(sqrt((double)(r * r - dy * dy)));
+        fill_span(ctx, center.y + dy, center.x - dx, center.x + dx, ctx->fill);
+    }
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1)
+{
+    count_draw_call();
+    int x0 = p0.x, y0 = p0.y;
+    const int dx = abs(p1.x - x0), sx = x0 < p1.x ? 1 : -1;
+    const int dy = -abs(p1.y - y0), sy = y0 < p1.y ? 1 : -1;
+    int err = dx + dy;
+    for (;;)
+    {
+        put_pixel(ctx, x0, y0, ctx->stroke);
+        if (x0 == p1.x && y0 == p1.y)
+        {
+            break;
+        }
+        const int e2 = 2 * err;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect)
+{
+    count_draw_call();
+    for (int y = 0; y < rect.size.h && y < bitmap->bounds.size.h; ++y)
+    {
+        for (int x = 0; x < rect.size.w && x < bitmap->bounds.size.w; ++x)
+        {
+            const uint8_t *row = bitmap->data + y * bitmap->row_bytes;
+            const bool white = bitmap->format == GBitmapFormat1Bit
+                ? (row[x / 8] >> (x % 8)) & 1
+                : row[x] != 0;
+            put_pixel(ctx, rect.origin.x + x, rect.origin.y + y, white ? GColorWhite : GColorBlack);
+        }
+    }
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format)
+{
+    GBitmap *bitmap = pbl_host_calloc(1, sizeof(GBitmap));
+    bitmap->format = format;
+    bitmap->row_bytes = format == GBitmapFormat1Bit ? (uint16_t)(((size.w + 31) / 32) * 4) : (uint16_t)size.w;
+    bitmap->bounds = GRect(0, 0, size.w, size.h);
+    bitmap->data = pbl_host_calloc(size.h, bitmap->row_bytes);
+    return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap)
+{
+    if (bitmap && bitmap != &frame_bitmap)
+    {
+        pbl_host_free(bitmap->data);
+        pbl_host_free(bitmap);
+    }
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap)
+{
+    return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap)
+{
+    return bitmap->row_bytes;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap)
+{
+    return bitmap->format;
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap)
+{
+    return bitmap->bounds;
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx)
+{
+    if (ctx->captured)
+    {
+        return NULL;
+    }
+    ctx->captured = true;
+    count_draw_call();
+    const uint64_t start = monotonic_nanos();
+    memcpy(captured_frame, frame_buffer, sizeof(frame_buffer));
+    accounting_nanos += monotonic_nanos() - start;
+    return &frame_bitmap;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *bitmap)
+{
+    if (!ctx->captured || bitmap != &frame_bitmap)
+    {
+        return false;
+    }
+    ctx->captured = false;
+    // a write through the frame buffer is only seen by what it changed, so
+    // pixels copied over equal ones are not counted
+    const uint64_t start = monotonic_nanos();
+    uint64_t changed = 0;
+    for (size_t i = 0; i < sizeof(frame_buffer); ++i)
+    {
+        changed += __builtin_popcount(captured_frame[i] ^ frame_buffer[i]);
+    }
+    count_pixels(changed);
+    accounting_nanos += monotonic_nanos() - start;
+    return true;
+}
+
+// paths
+
+GPath *gpath_create(const GPathInfo *info)
+{
+    GPath *path = pbl_host_calloc(1, sizeof(GPath));
+    path->num_points = info->num_points;
+    path->points = info->points;
+    return path;
+}
+
+void gpath_destroy(GPath *path)
+{
+    pbl_host_free(path);
+}
+
+void gpath_rotate_to(GPath *path, int32_t angle)
+{
+    path->rotation = angle;
+}
+
+void gpath_move_to(GPath *path, GPoint point)
+{
+    path->offset = point;
+}
+
+static GPoint transform_point(const GPath *path, GPoint p)
+{
+    const int32_t cosine = cos_lookup(path->rotation);
+    const int32_t sine = sin_lookup(path->rotation);
+    return GPoint(p.x * cosine / TRIG_MAX_RATIO - p.y * sine / TRIG_MAX_RATIO + path->offset.x,
+                  p.y * cosine / TRIG_MAX_RATIO + p.x * sine / TRIG_MAX_RATIO + path->offset.y);
+}
+
+void gpath_draw_filled(GContext *ctx, GPath *path)
+{
+    count_draw_call();
+    if (path->num_points < 3 || path->num_points > 16)
+    {
+        return;
+    }
+    GPoint points[16];
+    int min_y = INT16_MAX, max_y = INT16_MIN;
+    for (uint32_t i = 0; i < path->num_points; ++i)
+    {
+        points[i] = transform_point(path, path->points[i]);
+        min_y = points[i].y < min_y ? points[i].y : min_y;
+        max_y = points[i].y > max_y ? points[i].y : max_y;
+    }
+    for (int y = min_y; y <= max_y; ++y)
+    {
+        double xs[16];
+        int n = 0;
+        for (uint32_t i = 0; i < path->num_points; ++i)
+        {
+            const GPoint a = points[i];
+            const GPoint b = points[(i + 1) % path->num_points];
+            if (a.y == b.y || y < (a.y < b.y ? a.y : b.y) || y >= (a.y < b.y ? b.y : a.y))
+            {
+                continue;
+            }
+            xs[n++] = a.x + (double)(y - a.y) * (b.x - a.x) / (b.y - a.y);
+        }
+        for (int i = 1; i < n; ++i)
+        {
+            for (int j = i; j > 0 && xs[j - 1] > xs[j]; --j)
+            {
+                const double tmp = xs[j];
+                xs[j] = xs[j - 1];
+                xs[j - 1] = tmp;
+            }
+        }
+        for (int i = 0; i + 1 < n; i += 2)
+        {
+            fill_span(ctx, y, (int)lround(xs[i]), (int)lround(xs[i + 1]), ctx->fill);
+        }
+    }
+}
+
+void gpath_draw_outline(GContext *ctx, GPath *path)
+{
+    for (uint32_t i = 0; i < path->num_points; ++i)
+    {
+        graphics_draw_line(ctx, transform_point(path, path->points[i]),
+                           transform_point(path, path->points[(i + 1) % path->num_points]));
+    }
+}
+
+// text: every glyph is a solid block so layout changes still show up in
+// frame dumps and pixel counts
+
+GFont fonts_get_system_font(const char *key)
+{
+    return strcmp(key, FONT_KEY_GOTHIC_18) == 0 ? &gothic_18 : &gothic_14;
+}
+
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box,
+                        GTextOverflowMode overflow, GTextAlignment alignment, void *attributes)
+{
+    count_draw_call();
+    const int advance = font->height / 2;
+    const int width = (int)strlen(text) * advance;
+    int x = box.origin.x;
+    if (alignment == GTextAlignmentCenter)
+    {
+        x += (box.size.w - width) / 2;
+    }
+    else if (alignment == GTextAlignmentRight)
+    {
+        x += box.size.w - width;
+    }
+    const int y = box.origin.y + font->height / 4;
+    for (const char *c = text; *c; ++c, x += advance)
+    {
+        if (*c == ' ')
+        {
+            continue;
+        }
+        for (int dy = 0; dy < font->height / 2; ++dy)
+        {
+            fill_span(ctx, y + dy, x, x + advance - 2, ctx->text);
+        }
+    }
+}
+
+// layers
+
+static PblHostProcStats *stats_for(const char *name)
+{
+    for (size_t i = 0; i < num_proc_stats; ++i)
+    {
+        if (strcmp(proc_stats[i].name, name) == 0)
+        {
+            return &proc_stats[i];
+        }
+    }
+    if (num_proc_stats == PBL_HOST_MAX_PROCS)
+    {
+        return NULL;
+    }
+    proc_stats[num_proc_stats].name = name;
+    return &proc_stats[num_proc_stats++];
+}
+
+static void layer_init(Layer *layer, GRect frame)
+{
+    memset(layer, 0, sizeof(*layer));
+    layer->frame = frame;
+}
+
+Layer *layer_create(GRect frame)
+{
+    Layer *layer = pbl_host_malloc(sizeof(Layer));
+    layer_init(layer, frame);
+    return layer;
+}
+
+void layer_remove_from_parent(Layer *layer)
+{
+    Layer *parent = layer->parent;
+    if (!parent)
+    {
+        return;
+    }
+    for (size_t i = 0; i < parent->num_children; ++i)
+    {
+        if (parent->children[i] == layer)
+        {
+            memmove(&parent->children[i], &parent->children[i + 1],
+                    (parent->num_children - i - 1) * sizeof(Layer *));
+            parent->num_children--;
+            break;
+        }
+    }
+    layer->parent = NULL;
+    tree_dirty = true;
+}
+
+void layer_destroy(Layer *layer)
+{
+    if (!layer)
+    {
+        return;
+    }
+    layer_remove_from_parent(layer);
+    pbl_host_free(layer);
+}
+
+void pbl_host_layer_set_update_proc(Layer *layer, LayerUpdateProc proc, const char *name)
+{
+    layer->update_proc = proc;
+    layer->stats = proc ? stats_for(name) : NULL;
+}
+
+void layer_add_child(Layer *parent, Layer *child)
+{
+    if (parent->num_children == MAX_CHILDREN)
+    {
+        return;
+    }
+    child->parent = parent;
+    parent->children[parent->num_children++] = child;
+    tree_dirty = true;
+}
+
+void layer_mark_dirty(Layer *layer)
+{
+    tree_dirty = true;
+}
+
+GRect layer_get_bounds(const Layer *layer)
+{
+    return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+GRect layer_get_frame(const Layer *layer)
+{
+    return layer->frame;
+}
+
+void layer_set_frame(Layer *layer, GRect frame)
+{
+    layer->frame = frame;
+    tree_dirty = true;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden)
+{
+    layer->hidden = hidden;
+    tree_dirty = true;
+}
+
+static void text_layer_update_proc(Layer *layer, GContext *ctx)
+{
+    TextLayer *text_layer = (TextLayer *)layer;
+    if (text_layer->background != GColorClear)
+    {
+        graphics_context_set_fill_color(ctx, text_layer->background);
+        graphics_fill_rect(ctx, layer_get_bounds(layer), 0, GCornerNone);
+    }
+    if (text_layer->text)
+    {
+        graphics_context_set_text_color(ctx, text_layer->foreground);
+        graphics_draw_text(ctx, text_layer->text, text_layer->font, layer_get_bounds(layer),
+                           GTextOverflowModeWordWrap, text_layer->alignment, NULL);
+    }
+}
+
+TextLayer *text_layer_create(GRect frame)
+{
+    TextLayer *text_layer = pbl_host_malloc(sizeof(TextLayer));
+    layer_init(&text_layer->layer, frame);
+    text_layer->text = NULL;
+    text_layer->background = GColorWhite;
+    text_layer->foreground = GColorBlack;
+    text_layer->font = &gothic_14;
+    text_layer->alignment = GTextAlignmentLeft;
+    layer_set_update_proc(&text_layer->layer, text_layer_update_proc);
+    return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer)
+{
+    if (!text_layer)
+    {
+        return;
+    }
+    layer_remove_from_parent(&text_layer->layer);
+    pbl_host_free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer)
+{
+    return &text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text)
+{
+    text_layer->text = text;
+    tree_dirty = true;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color)
+{
+    text_layer->background = color;
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color)
+{
+    text_layer->foreground = color;
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font)
+{
+    text_layer->font = font;
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment alignment)
+{
+    text_layer->alignment = alignment;
+}
+
+// windows
+
+Window *window_create(void)
+{
+    Window *window = pbl_host_calloc(1, sizeof(Window));
+    layer_init(&window->root, GRect(0, 0, SCREEN_W, SCREEN_H));
+    window->background = GColorWhite;
+    return window;
+}
+
+void window_destroy(Window *window)
+{
+    if (!window)
+    {
+        return;
+    }
+    if (window == top_window)
+    {
+        if (window->handlers.disappear)
+        {
+            window->handlers.disappear(window);
+        }
+        if (window->handlers.unload)
+        {
+            window->handlers.unload(window);
+        }
+        top_window = NULL;
+    }
+    pbl_host_free(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers)
+{
+    window->handlers = handlers;
+}
+
+Layer *window_get_root_layer(const Window *window)
+{
+    return (Layer *)&window->root;
+}
+
+void window_set_background_color(Window *window, GColor color)
+{
+    window->background = color;
+}
+
+void window_stack_push(Window *window, bool animated)
+{
+    top_window = window;
+    if (window->handlers.load)
+    {
+        window->handlers.load(window);
+    }
+    if (window->handlers.appear)
+    {
+        window->handlers.appear(window);
+    }
+    tree_dirty = true;
+}
+
+static void render_layer(Layer *layer, GPoint origin, GRect clip)
+{
+    if (layer->hidden)
+    {
+        return;
+    }
+    origin.x += layer->frame.origin.x;
+    origin.y += layer->frame.origin.y;
+    GRect frame = { origin, layer->frame.size };
+    int16_t x0 = frame.origin.x > clip.origin.x ? frame.origin.x : clip.origin.x;
+    int16_t y0 = frame.origin.y > clip.origin.y ? frame.origin.y : clip.origin.y;
+    int16_t x1 = frame.origin.x + frame.size.w < clip.origin.x + clip.size.w
+        ? frame.origin.x + frame.size.w : clip.origin.x + clip.size.w;
+    int16_t y1 = frame.origin.y + frame.size.h < clip.origin.y + clip.size.h
+        ? frame.origin.y + frame.size.h : clip.origin.y + clip.size.h;
+    clip = GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+
+    if (layer->update_proc)
+    {
+        context.offset = origin;
+        context.clip = clip;
+        current_stats = layer->stats;
+        const uint64_t accounted = accounting_nanos;
+        const uint64_t start = monotonic_nanos();
+        layer->update_proc(layer, &context);
+        if (current_stats)
+        {
+            current_stats->calls++;
+            current_stats->nanos += monotonic_nanos() - start - (accounting_nanos - accounted);
+        }
+        current_stats = NULL;
+    }
+    for (size_t i = 0; i < layer->num_children; ++i)
+    {
+        render_layer(layer->children[i], origin, clip);
+    }
+}
+
+bool pbl_host_render(void)
+{
+    if (!top_window || !tree_dirty)
+    {
+        return false;
+    }
+    tree_dirty = false;
+    counters.frames++;
+    const GRect screen = GRect(0, 0, SCREEN_W, SCREEN_H);
+    context.offset = GPointZero;
+    context.clip = screen;
+    current_stats = NULL;
+    graphics_context_set_fill_color(&context, top_window->background);
+    if (top_window->background != GColorClear)
+    {
+        for (int y = 0; y < SCREEN_H; ++y)
+        {
+            fill_span(&context, y, 0, SCREEN_W - 1, top_window->background);
+        }
+    }
+    render_layer(&top_window->root, GPointZero, screen);
+    return true;
+}
+
+GContext *pbl_host_screen_context(void)
+{
+    context.offset = GPointZero;
+    context.clip = GRect(0, 0, SCREEN_W, SCREEN_H);
+    current_stats = NULL;
+    return &context;
+}
+
+// services
+
+void tick_timer_service_subscribe(TimeUnits units, TickHandler handler)
+{
+    tick_units = units;
+    tick_handler = handler;
+}
+
+void tick_timer_service_unsubscribe(void)
+{
+    tick_handler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void)
+{
+    return battery_state;
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler)
+{
+    battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(void)
+{
+    battery_handler = NULL;
+}
+
+void accel_tap_service_subscribe(AccelTapHandler handler)
+{
+    tap_handler = handler;
+}
+
+void accel_tap_service_unsubscribe(void)
+{
+    tap_handler = NULL;
+}
+
+// data logging sessions append their items to circlock-<tag>.dlog in the
+// working directory
+
+struct DataLoggingSession {
+    FILE *file;
+    uint16_t item_size;
+};
+
+DataLoggingSessionRef data_logging_create(uint32_t tag, DataLoggingItemType type, uint16_t item_size, bool resume)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "circlock-%08x.dlog", (unsigned)tag);
+    DataLoggingSessionRef session = pbl_host_calloc(1, sizeof(struct DataLoggingSession));
+    session->file = fopen(path, resume ? "ab" : "wb");
+    session->item_size = item_size;
+    return session;
+}
+
+DataLoggingResult data_logging_log(DataLoggingSessionRef session, const void *data, uint32_t count)
+{
+    if (!session || !session->file)
+    {
+        return DATA_LOGGING_CLOSED;
+    }
+    fwrite(data, session->item_size, count, session->file);
+    return DATA_LOGGING_SUCCESS;
+}
+
+void data_logging_finish(DataLoggingSessionRef session)
+{
+    if (session)
+    {
+        if (session->file)
+        {
+            fclose(session->file);
+        }
+        pbl_host_free(session);
+    }
+}
+
+// persistent storage lives until the next pbl_host_reset(), so a harness
+// can deinit and init the face again to see a cold start
+
+struct PersistEntry {
+    bool used;
+    uint32_t key;
+    uint16_t size;
+    uint8_t data[PERSIST_DATA_MAX_LENGTH];
+};
+
+static struct PersistEntry persist_entries[MAX_PERSIST_KEYS];
+
+static struct PersistEntry *persist_find(uint32_t key)
+{
+    for (size_t i = 0; i < MAX_PERSIST_KEYS; ++i)
+    {
+        if (persist_entries[i].used && persist_entries[i].key == key)
+        {
+            return &persist_entries[i];
+        }
+    }
+    return NULL;
+}
+
+bool persist_exists(const uint32_t key)
+{
+    return persist_find(key) != NULL;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size)
+{
+    const struct PersistEntry *entry = persist_find(key);
+    if (!entry)
+    {
+        return E_DOES_NOT_EXIST;
+    }
+    const size_t size = entry->size < buffer_size ? entry->size : buffer_size;
+    memcpy(buffer, entry->data, size);
+    return (int)size;
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size)
+{
+    if (size > PERSIST_DATA_MAX_LENGTH)
+    {
+        return E_INVALID_ARGUMENT;
+    }
+    struct PersistEntry *entry = persist_find(key);
+    size_t used = 0;
+    for (size_t i = 0; i < MAX_PERSIST_KEYS; ++i)
+    {
+        used += persist_entries[i].used && &persist_entries[i] != entry ? persist_entries[i].size : 0;
+    }
+    for (size_t i = 0; !entry && i < MAX_PERSIST_KEYS; ++i)
+    {
+        entry = persist_entries[i].used ? NULL : &persist_entries[i];
+    }
+    if (!entry || used + size > PERSIST_STORAGE_BYTES)
+    {
+        return E_OUT_OF_STORAGE;
+    }
+    entry->used = true;
+    entry->key = key;
+    entry->size = (uint16_t)size;
+    memcpy(entry->data, data, size);
+    return (int)size;
+}
+
+status_t persist_delete(const uint32_t key)
+{
+    struct PersistEntry *entry = persist_find(key);
+    if (!entry)
+    {
+        return E_DOES_NOT_EXIST;
+    }
+    entry->used = false;
+    return S_SUCCESS;
+}
+
+// app messages
+
+static AppMessageInboxReceived inbox_handler;
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key)
+{
+    for (size_t i = 0; i < iter->count; ++i)
+    {
+        if (iter->tuples[i].key == key)
+        {
+            return &iter->tuples[i];
+        }
+    }
+    return NULL;
+}
+
+AppMessageResult app_message_open(const uint32_t inbox_size, const uint32_t outbox_size)
+{
+    return APP_MSG_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived handler)
+{
+    const AppMessageInboxReceived previous = inbox_handler;
+    inbox_handler = handler;
+    return previous;
+}
+
+void app_message_deregister_callbacks(void)
+{
+    inbox_handler = NULL;
+}
+
+void app_focus_service_subscribe(AppFocusHandler handler)
+{
+    focus_handler = handler;
+}
+
+void app_focus_service_unsubscribe(void)
+{
+    focus_handler = NULL;
+}
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *data)
+{
+    for (size_t i = 0; i < MAX_TIMERS; ++i)
+    {
+        if (!timers[i].active)
+        {
+            timers[i] = (struct AppTimer){ true, now_ms + timeout_ms, callback, data };
+            return &timers[i];
+        }
+    }
+    return NULL;
+}
+
+bool app_timer_reschedule(AppTimer *timer, uint32_t timeout_ms)
+{
+    if (!timer || !timer->active)
+    {
+        return false;
+    }
+    timer->due_ms = now_ms + timeout_ms;
+    return true;
+}
+
+void app_timer_cancel(AppTimer *timer)
+{
+    if (timer)
+    {
+        timer->active = false;
+    }
+}
+
+void app_event_loop(void)
+{
+}
+
+// harness control
+
+void pbl_host_reset(time_t start)
+{
+    setenv("TZ", "UTC", 1);
+    tzset();
+    now_ms = (uint64_t)start * 1000;
+    memset(frame_buffer, 0, sizeof(frame_buffer));
+    memset(timers, 0, sizeof(timers));
+    memset(persist_entries, 0, sizeof(persist_entries));
+    inbox_handler = NULL;
+    tick_handler = NULL;
+    battery_handler = NULL;
+    tap_handler = NULL;
+    focus_handler = NULL;
+    top_window = NULL;
+    tree_dirty = false;
+    pbl_host_reset_stats();
+}
+
+void pbl_host_set_logging(bool enabled)
+{
+    logging = enabled;
+}
+
+static TimeUnits units_between(const struct tm *a, const struct tm *b)
+{
+    TimeUnits units = 0;
+    if (a->tm_sec != b->tm_sec)
+    {
+        units |= SECOND_UNIT;
+    }
+    if (a->tm_min != b->tm_min)
+    {
+        units |= MINUTE_UNIT;
+    }
+    if (a->tm_hour != b->tm_hour)
+    {
+        units |= HOUR_UNIT;
+    }
+    if (a->tm_mday != b->tm_mday)
+    {
+        units |= DAY_UNIT;
+    }
+    if (a->tm_mon != b->tm_mon)
+    {
+        units |= MONTH_UNIT;
+    }
+    if (a->tm_year != b->tm_year)
+    {
+        units |= YEAR_UNIT;
+    }
+    return units;
+}
+
+static struct AppTimer *next_timer(uint64_t until)
+{
+    struct AppTimer *next = NULL;
+    for (size_t i = 0; i < MAX_TIMERS; ++i)
+    {
+        if (timers[i].active && timers[i].due_ms <= until && (!next || timers[i].due_ms < next->due_ms))
+        {
+            next = &timers[i];
+        }
+    }
+    return next;
+}
+
+void pbl_host_advance(uint32_t ms)
+{
+    const uint64_t end = now_ms + ms;
+    while (now_ms < end)
+    {
+        const uint64_t next_second = (now_ms / 1000 + 1) * 1000;
+        const uint64_t step_end = next_second < end ? next_second : end;
+        struct AppTimer *timer;
+        while ((timer = next_timer(step_end)) != NULL)
+        {
+            now_ms = timer->due_ms > now_ms ? timer->due_ms : now_ms;
+            timer->active = false;
+            counters.wakeups++;
+            timer->callback(timer->data);
+            pbl_host_render();
+        }
+        if (step_end == next_second)
+        {
+            // a timer due on the second boundary has already moved now_ms
+            time_t before = (time_t)(next_second / 1000 - 1);
+            time_t after = (time_t)(next_second / 1000);
+            struct tm tm_before = *localtime(&before);
+            struct tm tm_after = *localtime(&after);
+            now_ms = next_second;
+            const TimeUnits changed = units_between(&tm_before, &tm_after);
+            if (tick_handler && (changed & tick_units))
+            {
+                counters.wakeups++;
+                tick_handler(&tm_after, changed);
+                pbl_host_render();
+            }
+        }
+        else
+        {
+            now_ms = end;
+        }
+    }
+}
+
+void pbl_host_battery(BatteryChargeState state)
+{
+    battery_state = state;
+    if (battery_handler)
+    {
+        counters.wakeups++;
+        battery_handler(state);
+        pbl_host_render();
+    }
+}
+
+void pbl_host_tap(void)
+{
+    if (tap_handler)
+    {
+        counters.wakeups++;
+        tap_handler(ACCEL_AXIS_Z, 1);
+        pbl_host_render();
+    }
+}
+
+void pbl_host_focus(bool in_focus)
+{
+    if (focus_handler)
+    {
+        counters.wakeups++;
+        focus_handler(in_focus);
+        pbl_host_render();
+    }
+}
+
+void pbl_host_app_message(Tuple *tuples, size_t count)
+{
+    if (inbox_handler)
+    {
+        DictionaryIterator iter = { tuples, count };
+        counters.wakeups++;
+        inbox_handler(&iter, NULL);
+        pbl_host_render();
+    }
+}
+
+const PblHostProcStats *pbl_host_proc_stats(size_t *count)
+{
+    *count = num_proc_stats;
+    return proc_stats;
+}
+
+PblHostCounters pbl_host_counters(void)
+{
+    return counters;
+}
+
+void pbl_host_reset_stats(void)
+{
+    for (size_t i = 0; i < num_proc_stats; ++i)
+    {
+        const char *name = proc_stats[i].name;
+        memset(&proc_stats[i], 0, sizeof(proc_stats[i]));
+        proc_stats[i].name = name;
+    }
+    memset(&counters, 0, sizeof(counters));
+}
+
+size_t pbl_host_persist_bytes_used(void)
+{
+    size_t used = 0;
+    for (size_t i = 0; i < MAX_PERSIST_KEYS; ++i)
+    {
+        used += persist_entries[i].used ? persist_entries[i].size : 0;
+    }
+    return used;
+}
+
+uint64_t pbl_host_accounting_nanos(void)
+{
+    return accounting_nanos;
+}
+
+const uint8_t *pbl_host_frame_buffer(void)
+{
+    return frame_buffer;
+}
+
+bool pbl_host_dump_pbm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        return false;
+    }
+    // PBM is MSB-first with 1 meaning black
+    fprintf(f, "P4\n%d %d\n", SCREEN_W, SCREEN_H);
+    for (int y = 0; y < SCREEN_H; ++y)
+    {
+        for (int x = 0; x < SCREEN_W; x += 8)
+        {
+            const uint8_t byte = frame_buffer[y * SCREEN_ROW_BYTES + x / 8];
+            uint8_t out = 0;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                out |= (uint8_t)((((byte >> bit) & 1) ^ 1) << (7 - bit));
+            }
+            fputc(out, f);
+        }
+    }
+    return fclose(f) == 0;
+}
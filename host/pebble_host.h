@@ -0,0 +1,72 @@
+// pebble_host.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Control interface of the host stand-in SDK, used by the harness only.
+
+#pragma once
+
+#include "pebble.h"
+
+#define PBL_HOST_SCREEN_WIDTH 144
+#define PBL_HOST_SCREEN_HEIGHT 168
+#define PBL_HOST_MAX_PROCS 32
+
+typedef struct PblHostProcStats {
+    const char *name;
+    uint64_t calls;
+    uint64_t nanos;
+    uint64_t draw_calls;
+    uint64_t pixels;
+} PblHostProcStats;
+
+typedef struct PblHostCounters {
+    uint64_t wakeups;
+    uint64_t frames;
+    uint64_t draw_calls;
+    uint64_t pixels;
+} PblHostCounters;
+
+extern void pbl_host_reset(time_t start);
+extern void pbl_host_set_logging(bool);
+
+// advances the simulated clock, firing ticks and timers and rendering after
+// every event that left the layer tree dirty
+extern void pbl_host_advance(uint32_t ms);
+extern void pbl_host_battery(BatteryChargeState);
+extern void pbl_host_tap(void);
+extern void pbl_host_focus(bool in_focus);
+extern void pbl_host_app_message(Tuple *tuples, size_t count);
+extern bool pbl_host_render(void);
+
+// a context for drawing on the whole screen outside of a frame
+extern GContext *pbl_host_screen_context(void);
+
+extern const PblHostProcStats *pbl_host_proc_stats(size_t *count);
+extern PblHostCounters pbl_host_counters(void);
+extern void pbl_host_reset_stats(void);
+// wall time the stand-in spent counting the pixels written through captured
+// frame buffers, for timing code that captures it
+extern uint64_t pbl_host_accounting_nanos(void);
+
+extern size_t pbl_host_persist_bytes_used(void);
+extern const uint8_t *pbl_host_frame_buffer(void);
+extern bool pbl_host_dump_pbm(const char *path);
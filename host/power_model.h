@@ -0,0 +1,61 @@
+// power_model.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Energy cost model for the events the stand-in SDK counts. Every wakeup,
+// display update, draw call and pixel written costs a fixed amount on top of
+// a constant idle draw. The defaults only have the right order of magnitude,
+// fit them to the drain tools/energy_report.py measures on a watch before
+// trusting the numbers. How two builds compare depends on the costs as much
+// as on the counts: with the defaults the idle draw is nearly all of a day,
+// so the report also gives the energy above it.
+
+#pragma once
+
+#include "pebble_host.h"
+
+typedef struct PowerModel {
+    double idle_uw;
+    double wakeup_uj;
+    double frame_uj;
+    double draw_call_uj;
+    double pixel_uj;
+    double battery_mwh;
+} PowerModel;
+
+// microjoules spent on each term over a span of simulated time
+typedef struct PowerEstimate {
+    double idle_uj;
+    double wakeup_uj;
+    double frame_uj;
+    double draw_call_uj;
+    double pixel_uj;
+} PowerEstimate;
+
+extern PowerModel power_model_default(void);
+
+// overrides the costs named in "idle=UW,wakeup=UJ,frame=UJ,draw=UJ,
+// pixel=UJ,battery=MWH", returns false on a malformed spec
+extern bool power_model_parse(PowerModel *, const char *spec);
+extern void power_model_print(const PowerModel *);
+
+extern PowerEstimate power_model_estimate(const PowerModel *, const PblHostCounters *, uint32_t seconds);
+extern double power_estimate_total(const PowerEstimate *);
@@ -25,172 +25,656 @@
 #include <pebble.h>
 
 #include "circlock_conf.h"
+#include "circlock_battery.h"
 #include "circlock_bg.h"
+#include "circlock_config.h"
+#include "circlock_energy.h"
+#include "circlock_geometry.h"
+#include "circlock_glyphs.h"
 #include "circlock_hands.h"
+#include "circlock_power.h"
+#include "circlock_render.h"
+#include "circlock_snapshot.h"
+#include "circlock_sweep.h"
+#include "circlock_trace.h"
+#include "circlock_util.h"
+
+// the labels are text layers unless they are drawn by an update proc of the
+// face, see CIRCLOCK_COMPACT_RENDER and CIRCLOCK_GLYPH_LABELS
+#define CIRCLOCK_TEXT_LAYERS (!CIRCLOCK_COMPACT_RENDER && !CIRCLOCK_GLYPH_LABELS)
 
 Window *window;
 
+// with CIRCLOCK_COMPACT_RENDER these are all the root layer of the window
 Layer *bg_layer;
 Layer *hands_layer;
+#if CIRCLOCK_FEATURE_BATTERY
 Layer *battery_layer;
+#endif
 
-Layer *date_layer;
+#if CIRCLOCK_TEXT_LAYERS
+#if CIRCLOCK_FEATURE_DATE
 TextLayer *date_label;
-static char date_buffer[15];
-
-Layer *time_layer;
+#endif
 TextLayer *time_label;
+#else
+Layer *labels_layer;
+#if CIRCLOCK_FEATURE_DATE
+static GFont date_font;
+#endif
+static GFont time_font;
+#endif
+static char date_buffer[15];
 static char time_buffer[8];
 
-static uint8_t charge_percent = 0;
-static bool is_charging = false;
+// the time of the current tick, shared by everything drawn for it
+static struct tm now;
+
+#if CIRCLOCK_SNAPSHOT
+// set from a launch that shows the snapshot of the last session until the
+// face has started up behind it
+static bool snapshot_showing = false;
+static AppTimer *startup_timer = NULL;
+#endif
+
+#if CIRCLOCK_FEATURE_DATE
+static const char DAY_NAMES[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char MONTH_NAMES[12][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+#endif
 
-static void date_update_proc(Layer *layer, GContext *ctx)
+static char *format_two_digits(char *out, int value)
 {
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+    *out++ = '0' + value / 10 % 10;
+    *out++ = '0' + value % 10;
+    return out;
+}
 
-    strftime(date_buffer, sizeof(date_buffer), "%a, %b %d", t);
-    text_layer_set_text(date_label, date_buffer);
+static char *format_name(char *out, const char *name)
+{
+    while (*name)
+    {
+        *out++ = *name++;
+    }
+    return out;
 }
 
-static void time_update_proc(Layer *layer, GContext *ctx)
+// "%I:%M%p"
+static void format_time(char *out, const struct tm *t)
 {
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+    const int hour = t->tm_hour % 12;
+    out = format_two_digits(out, hour == 0 ? 12 : hour);
+    *out++ = ':';
+    out = format_two_digits(out, t->tm_min);
+    out = format_name(out, t->tm_hour < 12 ? "AM" : "PM");
+    *out = '\0';
+}
 
-    strftime(time_buffer, sizeof(time_buffer), "%I:%M%p", t);
-    text_layer_set_text(time_label, time_buffer);
+#if CIRCLOCK_FEATURE_DATE
+// "%a, %b %d"
+static void format_date(char *out, const struct tm *t)
+{
+    out = format_name(out, DAY_NAMES[t->tm_wday % 7]);
+    *out++ = ',';
+    *out++ = ' ';
+    out = format_name(out, MONTH_NAMES[t->tm_mon % 12]);
+    *out++ = ' ';
+    out = format_two_digits(out, t->tm_mday);
+    *out = '\0';
 }
+#endif
 
-static void battery_update_proc(Layer *layer, GContext *ctx)
+// reformats only the labels whose fields changed
+static void update_labels(TimeUnits units_changed)
 {
-    const uint8_t div = charge_percent / 5;
-    const GRect bounds = layer_get_bounds(layer);
-    graphics_context_set_fill_color(ctx, CIRCLOCK_COLOR_FOREGROUND);
-    GRect frame = (GRect){
-        .origin = (GPoint){
-            3,
-            2 * CIRCLOCK_CLOCK_CENTER_Y + 20
-        },
-        .size = (GSize){
-            bounds.size.w / 20 - 1,
-            bounds.size.h
-        }
-    };
-    frame.size.h -= frame.origin.y;
-    int8_t i;
-    for (i = 0; i < div; ++i)
+    if (units_changed & (MINUTE_UNIT | HOUR_UNIT))
     {
-        graphics_fill_rect(ctx, frame, 4, GCornersAll);
-        frame.origin.x += frame.size.w + 1;
+        format_time(time_buffer, &now);
+#if CIRCLOCK_TEXT_LAYERS
+        text_layer_set_text(time_label, time_buffer);
+#endif
     }
+#if CIRCLOCK_FEATURE_DATE
+    if (units_changed & (DAY_UNIT | MONTH_UNIT | YEAR_UNIT))
+    {
+        format_date(date_buffer, &now);
+#if CIRCLOCK_TEXT_LAYERS
+        text_layer_set_text(date_label, date_buffer);
+#endif
+    }
+#endif
 }
 
-static void handle_battery(BatteryChargeState charge_state)
+static void set_labels_hidden(bool hidden)
 {
-    charge_percent = charge_state.charge_percent;
-    is_charging = charge_state.is_charging;
-    layer_set_update_proc(battery_layer, battery_update_proc);
+#if CIRCLOCK_TEXT_LAYERS
+#if CIRCLOCK_FEATURE_DATE
+    layer_set_hidden(text_layer_get_layer(date_label), hidden);
+#endif
+    layer_set_hidden(text_layer_get_layer(time_label), hidden);
+#elif !CIRCLOCK_COMPACT_RENDER
+    layer_set_hidden(labels_layer, hidden);
+#endif
 }
 
-static void handle_second_tick(struct tm *tick_time, TimeUnits units_changed)
+static void render_state(CirclockRenderState *state)
 {
-    handle_battery(battery_state_service_peek());
+    const CirclockLayout *layout = &circlock_geometry()->layout;
+    state->foreground = layout->foreground;
+    state->background = layout->background;
+    circlock_hands_get_state(&state->hands);
+    circlock_battery_get_state(&state->battery);
+    strcpy(state->labels.time, time_buffer);
+    strcpy(state->labels.date, date_buffer);
+}
+
+// Draws the whole face on the next frame. Every other frame only patches the
+// second ring into the retained frame buffer, with the labels hidden so they
+// are not drawn over themselves.
+static void request_full_frame()
+{
+    CirclockRenderState state;
+    render_state(&state);
+    circlock_render_request(&state, true);
+    circlock_bg_request_full_redraw();
+    set_labels_hidden(false);
     layer_mark_dirty(window_get_root_layer(window));
 }
 
-static void window_load(Window *window)
+// Redraws a layer on top of the retained frame buffer, unless nothing it
+// would draw has changed. Unless a full frame is already pending the labels
+// are hidden, text drawn over itself would not stay the same on anti-aliased
+// displays.
+static void request_patch_frame(Layer *layer)
+{
+    CirclockRenderState state;
+    render_state(&state);
+    if (!circlock_render_request(&state, circlock_bg_full_redraw_pending()))
+    {
+        return;
+    }
+    if (!circlock_bg_full_redraw_pending())
+    {
+        set_labels_hidden(true);
+    }
+    layer_mark_dirty(layer);
+}
+
+#if CIRCLOCK_ENERGY
+static CirclockEnergyMode energy_mode()
+{
+    if (circlock_sweep_running())
+    {
+        return CIRCLOCK_ENERGY_MODE_SWEEP;
+    }
+    return circlock_power_seconds_active() ? CIRCLOCK_ENERGY_MODE_SECONDS : CIRCLOCK_ENERGY_MODE_MINUTES;
+}
+#endif
+
+#if CIRCLOCK_FEATURE_BATTERY
+static void handle_battery_changed()
+{
+    circlock_energy_battery_changed();
+    request_patch_frame(battery_layer);
+}
+#endif
+
+#if CIRCLOCK_SWEEP
+static void handle_sweep_frame(uint8_t second, uint16_t millis)
+{
+    circlock_hands_set_second_position(second, millis);
+    request_patch_frame(hands_layer);
+}
+#endif
+
+static void handle_focus(bool in_focus)
 {
+    if (in_focus)
+    {
+        CIRCLOCK_TRACE_TRIGGER(CIRCLOCK_TRACE_TRIGGER_FOCUS);
+        request_full_frame();
+    }
+}
+
+static void handle_second_tick(struct tm *tick_time, TimeUnits units_changed)
+{
+    CIRCLOCK_TRACE_TRIGGER(units_changed & MINUTE_UNIT ? CIRCLOCK_TRACE_TRIGGER_MINUTE_TICK : CIRCLOCK_TRACE_TRIGGER_SECOND_TICK);
+    now = *tick_time;
+    // the sweep ends between ticks, its time is settled here
+    circlock_energy_set_mode(energy_mode());
+    circlock_hands_set_time(&now);
+    update_labels(units_changed);
+
+    // The firmware redraws the whole layer tree whichever layer is marked
+    // dirty, so marking only hands_layer saves no drawing by itself. The
+    // saving comes from the retained frame buffer: on a patch frame the
+    // background and the labels leave what it holds, and the hands only
+    // redraw the second ring, see request_patch_frame().
+    if (units_changed & MINUTE_UNIT)
+    {
+        // minute and hour hands move, redraw everything
+        request_full_frame();
+    }
+    else
+    {
+        request_patch_frame(hands_layer);
+    }
+}
+
+// the derived geometry is rebuilt once per change, the background cache with
+// it, and everything drawn from it moves to the new layout
+static void handle_config_changed(const CirclockConfig *config)
+{
+    circlock_geometry_init(layer_get_bounds(window_get_root_layer(window)).size, config);
+#if CIRCLOCK_TEXT_LAYERS
+    const CirclockLayout *layout = &circlock_geometry()->layout;
+#if CIRCLOCK_FEATURE_DATE
+    layer_set_frame(text_layer_get_layer(date_label), layout->date_rect);
+    text_layer_set_text_color(date_label, layout->foreground);
+#endif
+    layer_set_frame(text_layer_get_layer(time_label), layout->time_rect);
+    text_layer_set_text_color(time_label, layout->foreground);
+#endif
+    circlock_battery_invalidate();
+    circlock_bg_invalidate();
+    circlock_snapshot_invalidate();
+    request_full_frame();
+}
+
+#if CIRCLOCK_FEATURE_SECONDS
+
+static void handle_glance()
+{
+    circlock_sweep_start();
+    circlock_energy_set_mode(energy_mode());
+}
+
+static void handle_resolution_changed(bool seconds)
+{
+    CIRCLOCK_TRACE_TRIGGER(CIRCLOCK_TRACE_TRIGGER_RESOLUTION);
+    if (!seconds)
+    {
+        circlock_sweep_stop();
+    }
+    circlock_energy_set_mode(energy_mode());
+    // the last tick may be a minute old, the second hand starts from now
+    time_t seconds_now = time(NULL);
+    now = *localtime(&seconds_now);
+    circlock_hands_set_time(&now);
+    circlock_hands_set_second_visible(seconds);
+    request_full_frame();
+}
+
+#endif
+
+// the hands are all that sweep frames draw, their cost paces the sweep
+static void hands_update_proc(Layer *layer, GContext *ctx)
+{
+#if CIRCLOCK_SWEEP
+    if (circlock_sweep_running())
+    {
+        const uint32_t start = circlock_util_now_ms();
+        circlock_hands_update_proc(layer, ctx);
+        circlock_sweep_frame_drawn(start);
+        return;
+    }
+#endif
+    circlock_hands_update_proc(layer, ctx);
+}
+
+// every frame starts with the background, frames are counted there
+static void bg_update_proc(Layer *layer, GContext *ctx)
+{
+    circlock_bg_update_proc(layer, ctx);
+    circlock_render_frame_drawn(circlock_bg_frame_is_full());
+}
+
+#if CIRCLOCK_FEATURE_BATTERY
+// the battery gauge is drawn last
+static void battery_update_proc(Layer *layer, GContext *ctx)
+{
+    circlock_battery_update_proc(layer, ctx);
+}
+#endif
+
+static void snapshot_capture_proc(Layer *layer, GContext *ctx)
+{
+    circlock_snapshot_capture(layer, ctx);
+}
+
+// timing probes around every update proc, see CIRCLOCK_TRACE
+CIRCLOCK_TRACE_PROC(bg_update_proc, CIRCLOCK_TRACE_LAYER_BG)
+CIRCLOCK_TRACE_PROC(hands_update_proc, CIRCLOCK_TRACE_LAYER_HANDS)
+#if CIRCLOCK_FEATURE_BATTERY
+CIRCLOCK_TRACE_PROC(battery_update_proc, CIRCLOCK_TRACE_LAYER_BATTERY)
+#endif
+CIRCLOCK_TRACE_PROC(snapshot_capture_proc, CIRCLOCK_TRACE_LAYER_SNAPSHOT)
+
+// Full frames are complete after the last layer, one every
+// CIRCLOCK_SNAPSHOT_INTERVAL_SECONDS is kept for the snapshot of the next
+// launch. The capture has its own probe, apart from the layer's.
+static void last_layer_update_proc(Layer *layer, GContext *ctx)
+{
+#if CIRCLOCK_FEATURE_BATTERY
+    CIRCLOCK_TRACED(battery_update_proc)(layer, ctx);
+#else
+    CIRCLOCK_TRACED(hands_update_proc)(layer, ctx);
+#endif
+    if (circlock_bg_frame_is_full() && circlock_snapshot_due())
+    {
+        CIRCLOCK_TRACED(snapshot_capture_proc)(layer, ctx);
+    }
+}
+
+#if !CIRCLOCK_TEXT_LAYERS
+
+static void draw_label(Layer *layer, GContext *ctx, CirclockGlyphFont glyphs, GFont font, const char *text, GRect rect)
+{
+    const GColor color = circlock_geometry()->layout.foreground;
+#if CIRCLOCK_GLYPH_LABELS
+    if (circlock_glyphs_draw(layer, ctx, glyphs, text, rect, color))
+    {
+        return;
+    }
+#endif
+    graphics_context_set_text_color(ctx, color);
+    graphics_draw_text(ctx, text, font, rect, GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
+
+static void labels_update_proc(Layer *layer, GContext *ctx)
+{
+    const CirclockLayout *layout = &circlock_geometry()->layout;
+#if CIRCLOCK_FEATURE_DATE
+    draw_label(layer, ctx, CIRCLOCK_GLYPHS_DATE, date_font, date_buffer, layout->date_rect);
+#endif
+    draw_label(layer, ctx, CIRCLOCK_GLYPHS_TIME, time_font, time_buffer, layout->time_rect);
+}
+
+CIRCLOCK_TRACE_PROC(labels_update_proc, CIRCLOCK_TRACE_LAYER_LABELS)
+
+#endif
+
+#if CIRCLOCK_COMPACT_RENDER
+
+// Draws the face in the order the layers would stack. The labels are only
+// drawn on full frames, like the hidden text layers of the layer tree.
+static void compact_update_proc(Layer *layer, GContext *ctx)
+{
+    CIRCLOCK_TRACED(bg_update_proc)(layer, ctx);
+    if (circlock_bg_frame_is_full())
+    {
+        CIRCLOCK_TRACED(labels_update_proc)(layer, ctx);
+    }
+#if CIRCLOCK_FEATURE_BATTERY
+    CIRCLOCK_TRACED(hands_update_proc)(layer, ctx);
+#endif
+    last_layer_update_proc(layer, ctx);
+}
+
+static void load_layers(Window *window)
+{
+    const size_t heap_before = heap_bytes_used();
+    Layer *window_layer = window_get_root_layer(window);
+    // the root layer draws over the retained frame buffer itself
+    window_set_background_color(window, GColorClear);
+
+#if CIRCLOCK_FEATURE_DATE
+    date_font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+#endif
+    time_font = fonts_get_system_font(FONT_KEY_GOTHIC_18);
+    bg_layer = window_layer;
+    labels_layer = window_layer;
+    hands_layer = window_layer;
+#if CIRCLOCK_FEATURE_BATTERY
+    battery_layer = window_layer;
+#endif
+    layer_set_update_proc(window_layer, compact_update_proc);
+    circlock_battery_init(battery_layer, handle_battery_changed);
+    APP_LOG(APP_LOG_LEVEL_INFO, "compact render: heap %u bytes before load, %u after",
+            (unsigned)heap_before, (unsigned)heap_bytes_used());
+}
+
+#else
+
+static void load_layers(Window *window)
+{
+    const size_t heap_before = heap_bytes_used();
     Layer *window_layer = window_get_root_layer(window);
     const GRect bounds = layer_get_bounds(window_layer);
-    GPoint center = grect_center_point(&bounds);
+
+    // the frame buffer is retained between frames, the window must not
+    // clear it
+    window_set_background_color(window, GColorClear);
 
     // init layers
     bg_layer = layer_create(bounds);
-    layer_set_update_proc(bg_layer, circlock_bg_update_proc);
+    layer_set_update_proc(bg_layer, CIRCLOCK_TRACED(bg_update_proc));
     layer_add_child(window_layer, bg_layer);
-    
-    // init date layer -> a plain parent layer to create a date update proc
-    date_layer = layer_create(bounds);
-    layer_set_update_proc(date_layer, date_update_proc);
-    layer_add_child(window_layer, date_layer);
 
+#if CIRCLOCK_TEXT_LAYERS
+    const CirclockLayout *layout = &circlock_geometry()->layout;
+
+#if CIRCLOCK_FEATURE_DATE
     // init date
-    const int16_t date_label_width = 80;
-    date_label = text_layer_create(GRect(center.x - date_label_width / 2, 2 * CIRCLOCK_CLOCK_CENTER_Y + 2, date_label_width, 20));
+    date_label = text_layer_create(layout->date_rect);
     text_layer_set_text(date_label, date_buffer);
     text_layer_set_background_color(date_label, GColorClear);
-    text_layer_set_text_color(date_label, CIRCLOCK_COLOR_FOREGROUND);
+    text_layer_set_text_color(date_label, layout->foreground);
     GFont norm18 = fonts_get_system_font(FONT_KEY_GOTHIC_14);
     text_layer_set_font(date_label, norm18);
     text_layer_set_text_alignment(date_label, GTextAlignmentCenter);
-    layer_add_child(date_layer, text_layer_get_layer(date_label));
-    
-    // init time layer -> a plain parent layer to create a date update proc
-    time_layer = layer_create(bounds);
-    layer_set_update_proc(time_layer, time_update_proc);
-    layer_add_child(window_layer, time_layer);
+    layer_add_child(window_layer, text_layer_get_layer(date_label));
+#endif
 
     // init time
-    time_label = text_layer_create(GRect(10, CIRCLOCK_CLOCK_CENTER_Y - 10, bounds.size.w - 20, 20));
+    time_label = text_layer_create(layout->time_rect);
     text_layer_set_text(time_label, time_buffer);
     text_layer_set_background_color(time_label, GColorClear);
-    text_layer_set_text_color(time_label, CIRCLOCK_COLOR_FOREGROUND);
+    text_layer_set_text_color(time_label, layout->foreground);
     GFont norm14 = fonts_get_system_font(FONT_KEY_GOTHIC_18);
     text_layer_set_font(time_label, norm14);
     text_layer_set_text_alignment(time_label, GTextAlignmentCenter);
-    layer_add_child(time_layer, text_layer_get_layer(time_label));
+    layer_add_child(window_layer, text_layer_get_layer(time_label));
+#else
+    // init date and time
+#if CIRCLOCK_FEATURE_DATE
+    date_font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+#endif
+    time_font = fonts_get_system_font(FONT_KEY_GOTHIC_18);
+    labels_layer = layer_create(bounds);
+    layer_set_update_proc(labels_layer, CIRCLOCK_TRACED(labels_update_proc));
+    layer_add_child(window_layer, labels_layer);
+#endif
 
     // init hands
     hands_layer = layer_create(bounds);
-    layer_set_update_proc(hands_layer, circlock_hands_update_proc);
+#if CIRCLOCK_FEATURE_BATTERY
+    layer_set_update_proc(hands_layer, CIRCLOCK_TRACED(hands_update_proc));
+#else
+    layer_set_update_proc(hands_layer, last_layer_update_proc);
+#endif
     layer_add_child(window_layer, hands_layer);
     
+#if CIRCLOCK_FEATURE_BATTERY
     // init battery
     battery_layer = layer_create(bounds);
-    layer_set_update_proc(battery_layer, battery_update_proc);
+    layer_set_update_proc(battery_layer, last_layer_update_proc);
     layer_add_child(window_layer, battery_layer);
+    circlock_battery_init(battery_layer, handle_battery_changed);
+#endif
+    APP_LOG(APP_LOG_LEVEL_INFO, "layer tree: heap %u bytes before load, %u after",
+            (unsigned)heap_before, (unsigned)heap_bytes_used());
+}
+
+#endif
+
+static void window_load(Window *window)
+{
+#if CIRCLOCK_SNAPSHOT
+    // loaded once the snapshot is on screen, see handle_startup()
+    if (snapshot_showing)
+    {
+        return;
+    }
+#endif
+    load_layers(window);
+}
+
+static void window_appear(Window *window)
+{
+#if CIRCLOCK_SNAPSHOT
+    if (snapshot_showing)
+    {
+        return;
+    }
+#endif
+    request_full_frame();
 }
 
 static void window_unload(Window *window)
 {
+#if CIRCLOCK_SNAPSHOT
+    if (snapshot_showing)
+    {
+        return;
+    }
+#endif
+    circlock_battery_deinit();
+#if !CIRCLOCK_COMPACT_RENDER
+#if CIRCLOCK_FEATURE_BATTERY
     layer_destroy(battery_layer);
+#endif
     layer_destroy(hands_layer);
+#if CIRCLOCK_TEXT_LAYERS
     text_layer_destroy(time_label);
-    layer_destroy(time_layer);
+#if CIRCLOCK_FEATURE_DATE
     text_layer_destroy(date_label);
-    layer_destroy(date_layer);
+#endif
+#else
+    layer_destroy(labels_layer);
+#endif
     layer_destroy(bg_layer);
+#endif
+}
+
+// everything the first frame of the face is drawn from
+static void init_face()
+{
+    time_t seconds = time(NULL);
+    now = *localtime(&seconds);
+
+    circlock_config_init(handle_config_changed);
+    circlock_geometry_init(layer_get_bounds(window_get_root_layer(window)).size, circlock_config());
+    circlock_bg_init();
+    circlock_hands_init(window_get_root_layer(window));
+    circlock_hands_set_time(&now);
+    circlock_sweep_init(handle_sweep_frame);
+}
+
+static void start_services()
+{
+    update_labels(MINUTE_UNIT | HOUR_UNIT | DAY_UNIT | MONTH_UNIT | YEAR_UNIT);
+
+    circlock_energy_init();
+#if CIRCLOCK_FEATURE_SECONDS
+    circlock_power_init((CirclockPowerHandlers) {
+        .tick = handle_second_tick,
+        .resolution_changed = handle_resolution_changed,
+        .glance = handle_glance,
+    });
+#else
+    circlock_power_init((CirclockPowerHandlers) {
+        .tick = handle_second_tick,
+    });
+#endif
+    app_focus_service_subscribe(&handle_focus);
+}
+
+#if CIRCLOCK_SNAPSHOT
+
+static void handle_startup(void *data)
+{
+    startup_timer = NULL;
+    snapshot_showing = false;
+    layer_set_update_proc(window_get_root_layer(window), NULL);
+    init_face();
+    load_layers(window);
+    start_services();
+    request_full_frame();
+}
+
+// The snapshot is the whole first frame. The face starts up from a timer
+// after it, so nothing holds the frame back.
+static void snapshot_update_proc(Layer *layer, GContext *ctx)
+{
+    circlock_snapshot_draw(layer, ctx);
+    if (!startup_timer)
+    {
+        startup_timer = app_timer_register(0, handle_startup, NULL);
+    }
 }
 
+#endif
+
 void circlock_init()
 {
     window = window_create();
     window_set_window_handlers(window, (WindowHandlers) {
         .load = window_load,
+        .appear = window_appear,
         .unload = window_unload,
     });
     
-    date_buffer[0] = '\0';
-    time_buffer[0] = '\0';
-    
-    circlock_bg_init();
-    circlock_hands_init(window_get_root_layer(window));
+    circlock_snapshot_init();
+    circlock_trace_init();
+    circlock_render_init();
+#if CIRCLOCK_SNAPSHOT
+    if (circlock_snapshot_load())
+    {
+        // no animation either, the snapshot is meant to be on screen at once
+        snapshot_showing = true;
+        layer_set_update_proc(window_get_root_layer(window), snapshot_update_proc);
+        window_stack_push(window, false);
+        return;
+    }
+#endif
+    init_face();
     
     const bool animated = true;
     window_stack_push(window, animated);
-
-    tick_timer_service_subscribe(SECOND_UNIT, &handle_second_tick);
-    battery_state_service_subscribe(&handle_battery);
+    start_services();
 }
 
 void circlock_deinit()
 {
-    battery_state_service_unsubscribe();
-    tick_timer_service_unsubscribe();
+#if CIRCLOCK_SNAPSHOT
+    // closed before the face started up, the snapshot stays as it was
+    if (snapshot_showing)
+    {
+        if (startup_timer)
+        {
+            app_timer_cancel(startup_timer);
+            startup_timer = NULL;
+        }
+        circlock_render_deinit();
+        circlock_trace_deinit();
+        window_destroy(window);
+        snapshot_showing = false;
+        return;
+    }
+#endif
+    app_focus_service_unsubscribe();
+    circlock_power_deinit();
+    circlock_energy_deinit();
+    circlock_snapshot_deinit();
+    circlock_sweep_deinit();
     circlock_hands_deinit();
     circlock_bg_deinit();
+    circlock_geometry_deinit();
+    circlock_config_deinit();
+    circlock_render_deinit();
+    circlock_trace_deinit();
     
     window_destroy(window);
 }
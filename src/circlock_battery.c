@@ -0,0 +1,220 @@
+// circlock_battery.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_battery.h"
+
+#if CIRCLOCK_FEATURE_BATTERY
+
+#include "circlock_bg.h"
+#include "circlock_geometry.h"
+#include "circlock_trace.h"
+
+#define BATTERY_SEGMENTS 20
+#define BATTERY_PERCENT_PER_SEGMENT (100 / BATTERY_SEGMENTS)
+
+static CirclockBatteryChangedHandler changed_handler = NULL;
+static GRect segments[BATTERY_SEGMENTS];
+
+static uint8_t charged_segments = 0;
+static bool is_charging = false;
+static AppTimer *charging_timer = NULL;
+static bool charging_blink = false;
+
+// what the retained frame buffer currently shows
+static uint8_t drawn_segments = 0;
+static int8_t drawn_blink = -1;
+
+static void fill_segment(GContext *ctx, uint8_t index, bool on)
+{
+    if (on)
+    {
+        graphics_context_set_fill_color(ctx, circlock_geometry()->layout.foreground);
+        graphics_fill_rect(ctx, segments[index], 4, GCornersAll);
+    }
+    else
+    {
+        graphics_context_set_fill_color(ctx, circlock_geometry()->layout.background);
+        graphics_fill_rect(ctx, segments[index], 0, GCornerNone);
+    }
+}
+
+// the charging indicator is the segment after the charged ones
+static int8_t blink_segment()
+{
+    return is_charging && charging_blink && charged_segments < BATTERY_SEGMENTS ? charged_segments : -1;
+}
+
+void circlock_battery_update_proc(Layer *layer, GContext *ctx)
+{
+    if (circlock_bg_frame_is_full())
+    {
+        drawn_segments = 0;
+        drawn_blink = -1;
+    }
+
+    const int8_t blink = blink_segment();
+    if (drawn_segments == charged_segments && drawn_blink == blink)
+    {
+        circlock_render_part_drawn(CIRCLOCK_RENDER_BATTERY, false);
+        return;
+    }
+    circlock_render_part_drawn(CIRCLOCK_RENDER_BATTERY, true);
+
+    if (drawn_blink >= 0 && drawn_blink != blink && drawn_blink >= charged_segments)
+    {
+        fill_segment(ctx, drawn_blink, false);
+    }
+    drawn_blink = -1;
+
+    uint8_t i;
+    for (i = charged_segments; i < drawn_segments; ++i)
+    {
+        fill_segment(ctx, i, false);
+    }
+    for (i = drawn_segments; i < charged_segments; ++i)
+    {
+        fill_segment(ctx, i, true);
+    }
+    drawn_segments = charged_segments;
+
+    if (blink >= 0)
+    {
+        fill_segment(ctx, blink, true);
+        drawn_blink = blink;
+    }
+}
+
+static void handle_charging_timer(void *data);
+
+// the timer only runs while there is a segment left to blink, a full
+// battery on the charger has none
+static void update_charging_timer()
+{
+    const bool blinking = is_charging && charged_segments < BATTERY_SEGMENTS;
+    if (blinking && !charging_timer)
+    {
+        charging_timer = app_timer_register(1000 / CIRCLOCK_BATTERY_CHARGING_FPS, handle_charging_timer, NULL);
+    }
+    else if (!blinking && charging_timer)
+    {
+        app_timer_cancel(charging_timer);
+        charging_timer = NULL;
+    }
+    if (!blinking)
+    {
+        charging_blink = false;
+    }
+}
+
+static void handle_charging_timer(void *data)
+{
+    CIRCLOCK_TRACE_TRIGGER(CIRCLOCK_TRACE_TRIGGER_CHARGING);
+    charging_timer = NULL;
+    charging_blink = !charging_blink;
+    update_charging_timer();
+    if (changed_handler)
+    {
+        changed_handler();
+    }
+}
+
+static void set_charging(bool charging)
+{
+    is_charging = charging;
+    charging_blink = false;
+    update_charging_timer();
+}
+
+static void handle_battery(BatteryChargeState charge_state)
+{
+    const uint8_t charged = charge_state.charge_percent / BATTERY_PERCENT_PER_SEGMENT;
+    if (charged == charged_segments && charge_state.is_charging == is_charging)
+    {
+        return;
+    }
+    CIRCLOCK_TRACE_TRIGGER(CIRCLOCK_TRACE_TRIGGER_BATTERY);
+    charged_segments = charged > BATTERY_SEGMENTS ? BATTERY_SEGMENTS : charged;
+    if (charge_state.is_charging != is_charging)
+    {
+        set_charging(charge_state.is_charging);
+    }
+    else
+    {
+        update_charging_timer();
+    }
+    if (changed_handler)
+    {
+        changed_handler();
+    }
+}
+
+void circlock_battery_invalidate()
+{
+    const GRect gauge = circlock_geometry()->layout.battery_rect;
+    GRect frame = (GRect){
+        .origin = (GPoint){
+            gauge.origin.x + 3,
+            gauge.origin.y
+        },
+        .size = (GSize){
+            gauge.size.w / BATTERY_SEGMENTS - 1,
+            gauge.size.h
+        }
+    };
+    uint8_t i;
+    for (i = 0; i < BATTERY_SEGMENTS; ++i)
+    {
+        segments[i] = frame;
+        frame.origin.x += frame.size.w + 1;
+    }
+    drawn_segments = 0;
+    drawn_blink = -1;
+}
+
+void circlock_battery_get_state(CirclockBatteryState *state)
+{
+    *state = (CirclockBatteryState){
+        .segments = charged_segments,
+        .blink = blink_segment()
+    };
+}
+
+void circlock_battery_init(Layer *layer, CirclockBatteryChangedHandler handler)
+{
+    circlock_battery_invalidate();
+    changed_handler = NULL;
+    const BatteryChargeState charge_state = battery_state_service_peek();
+    charged_segments = 0;
+    is_charging = false;
+    handle_battery(charge_state);
+    changed_handler = handler;
+    battery_state_service_subscribe(&handle_battery);
+}
+
+void circlock_battery_deinit()
+{
+    battery_state_service_unsubscribe();
+    set_charging(false);
+    changed_handler = NULL;
+}
+
+#endif
@@ -0,0 +1,49 @@
+// circlock_battery.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+#include "circlock_render.h"
+
+// called whenever the gauge needs to be redrawn
+typedef void (*CirclockBatteryChangedHandler)();
+
+#if CIRCLOCK_FEATURE_BATTERY
+
+extern void circlock_battery_update_proc(Layer *, GContext *);
+extern void circlock_battery_invalidate();
+extern void circlock_battery_get_state(CirclockBatteryState *);
+extern void circlock_battery_init(Layer *, CirclockBatteryChangedHandler);
+extern void circlock_battery_deinit();
+
+#else
+
+#define circlock_battery_update_proc(layer, ctx)
+#define circlock_battery_invalidate()
+#define circlock_battery_get_state(state) (*(state) = (CirclockBatteryState){ .segments = 0, .blink = -1 })
+#define circlock_battery_init(layer, handler)
+#define circlock_battery_deinit()
+
+#endif
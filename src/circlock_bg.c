@@ -23,42 +23,256 @@
 #include "circlock_bg.h"
 
 #include "circlock_conf.h"
+#include "circlock_geometry.h"
+#include "circlock_util.h"
 
 void draw_fill_circle(GContext *ctx, GPoint center, uint16_t *radius)
 {
-    graphics_context_set_fill_color(ctx, CIRCLOCK_COLOR_FOREGROUND);
+    const CirclockGeometry *geometry = circlock_geometry();
+    graphics_context_set_fill_color(ctx, geometry->layout.foreground);
     graphics_fill_circle(ctx, center, *radius);
     
-    *radius -= CIRCLOCK_HAND_HEIGHT;
-    graphics_context_set_fill_color(ctx, CIRCLOCK_COLOR_BACKGROUND);
+    *radius -= geometry->config.hand_height;
+    graphics_context_set_fill_color(ctx, geometry->layout.background);
     graphics_fill_circle(ctx, center, *radius);
     
-    *radius -= CIRCLOCK_HAND_MARGIN;
+    *radius -= geometry->config.hand_margin;
 }
 
-void circlock_bg_update_proc(Layer *layer, GContext *ctx)
+// the static background is rasterized once and then copied straight into
+// the frame buffer, see circlock_bg_invalidate() for rebuilding it
+static GBitmap *bg_cache = NULL;
+static bool bg_cache_valid = false;
+
+// frames after the first only patch the retained frame buffer, until a full
+// redraw is requested again
+static bool full_redraw_pending = true;
+static bool frame_is_full = true;
+
+#if CIRCLOCK_BG_PROFILE
+static uint32_t profile_blit_ms = 0;
+static uint16_t profile_blit_frames = 0;
+#endif
+
+static void draw_background(Layer *layer, GContext *ctx)
 {
-    graphics_context_set_fill_color(ctx, CIRCLOCK_COLOR_BACKGROUND);
+    const CirclockGeometry *geometry = circlock_geometry();
+    graphics_context_set_fill_color(ctx, geometry->layout.background);
     graphics_fill_rect(ctx, layer_get_bounds(layer), 0, GCornerNone);
     
-    const GRect bounds = layer_get_bounds(layer);
-    GPoint center = grect_center_point(&bounds);
-    center.y = CIRCLOCK_CLOCK_CENTER_Y;
+    const GPoint center = geometry->layout.center;
     
-    uint16_t radius = CIRCLOCK_CLOCK_RADIUS;
-    draw_fill_circle(ctx, center, &radius);
-    draw_fill_circle(ctx, center, &radius);
-    draw_fill_circle(ctx, center, &radius);
+    uint16_t radius = geometry->config.clock_radius;
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        draw_fill_circle(ctx, center, &radius);
+    }
     
-    graphics_context_set_stroke_color(ctx, CIRCLOCK_COLOR_FOREGROUND);
-    graphics_draw_line(ctx, (GPoint){10, 2 * CIRCLOCK_CLOCK_CENTER_Y}, (GPoint){bounds.size.w - 10, 2 * CIRCLOCK_CLOCK_CENTER_Y});
+#if CIRCLOCK_FEATURE_DATE || CIRCLOCK_FEATURE_BATTERY
+    // between the clock and whatever is drawn below it
+    const GRect bounds = layer_get_bounds(layer);
+    const int16_t separator_y = geometry->layout.separator_y;
+    graphics_context_set_stroke_color(ctx, geometry->layout.foreground);
+    graphics_draw_line(ctx, (GPoint){10, separator_y}, (GPoint){bounds.size.w - 10, separator_y});
+#endif
+}
+
+static void copy_rows(GBitmap *dest, GBitmap *src)
+{
+    const uint16_t dest_row = gbitmap_get_bytes_per_row(dest);
+    const uint16_t src_row = gbitmap_get_bytes_per_row(src);
+    const uint16_t row = dest_row < src_row ? dest_row : src_row;
+    const int16_t height = gbitmap_get_bounds(dest).size.h;
+    uint8_t *dest_data = gbitmap_get_data(dest);
+    const uint8_t *src_data = gbitmap_get_data(src);
+    int16_t y;
+    for (y = 0; y < height; ++y)
+    {
+        memcpy(dest_data + y * dest_row, src_data + y * src_row, row);
+    }
+}
+
+static bool cache_matches(GBitmap *frame_buffer, Layer *layer)
+{
+    const GBitmapFormat format = gbitmap_get_format(frame_buffer);
+    if (format != GBitmapFormat1Bit && format != GBitmapFormat8Bit)
+    {
+        return false;
+    }
+    const GRect fb_bounds = gbitmap_get_bounds(frame_buffer);
+    const GRect frame = layer_get_frame(layer);
+    return frame.origin.x == fb_bounds.origin.x && frame.origin.y == fb_bounds.origin.y
+        && frame.size.w == fb_bounds.size.w && frame.size.h == fb_bounds.size.h;
 }
 
+static void build_cache(Layer *layer, GContext *ctx)
+{
+    draw_background(layer, ctx);
+
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        return;
+    }
+    if (cache_matches(frame_buffer, layer))
+    {
+        if (!bg_cache)
+        {
+            bg_cache = gbitmap_create_blank(gbitmap_get_bounds(frame_buffer).size, gbitmap_get_format(frame_buffer));
+        }
+        if (bg_cache)
+        {
+            copy_rows(bg_cache, frame_buffer);
+            bg_cache_valid = true;
+        }
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+}
+
+void circlock_bg_update_proc(Layer *layer, GContext *ctx)
+{
+    frame_is_full = full_redraw_pending || !bg_cache_valid;
+    full_redraw_pending = false;
+    if (!frame_is_full)
+    {
+        return;
+    }
+
+    if (!bg_cache_valid)
+    {
+#if CIRCLOCK_BG_PROFILE
+        const uint32_t start = circlock_util_now_ms();
+        build_cache(layer, ctx);
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "bg: rasterized in %u ms", (unsigned)(circlock_util_now_ms() - start));
+#else
+        build_cache(layer, ctx);
+#endif
+        return;
+    }
+
+#if CIRCLOCK_BG_PROFILE
+    const uint32_t start = circlock_util_now_ms();
+#endif
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        draw_background(layer, ctx);
+        return;
+    }
+    copy_rows(frame_buffer, bg_cache);
+    graphics_release_frame_buffer(ctx, frame_buffer);
+#if CIRCLOCK_BG_PROFILE
+    profile_blit_ms += circlock_util_now_ms() - start;
+    if (++profile_blit_frames == 60)
+    {
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "bg: %u ms per 60 cached frames", (unsigned)profile_blit_ms);
+        profile_blit_ms = 0;
+        profile_blit_frames = 0;
+    }
+#endif
+}
+
+void circlock_bg_invalidate()
+{
+    bg_cache_valid = false;
+    full_redraw_pending = true;
+}
+
+void circlock_bg_request_full_redraw()
+{
+    full_redraw_pending = true;
+}
+
+bool circlock_bg_full_redraw_pending()
+{
+    return full_redraw_pending || !bg_cache_valid;
+}
+
+bool circlock_bg_frame_is_full()
+{
+    return frame_is_full;
+}
+
+#if CIRCLOCK_FEATURE_SECONDS
+
+GRect circlock_bg_restore_rect(GContext *ctx, GRect rect)
+{
+    if (!bg_cache_valid)
+    {
+        return GRectZero;
+    }
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        return GRectZero;
+    }
+
+    const GRect bounds = gbitmap_get_bounds(frame_buffer);
+    int16_t x0 = rect.origin.x < 0 ? 0 : rect.origin.x;
+    int16_t y0 = rect.origin.y < 0 ? 0 : rect.origin.y;
+    int16_t x1 = rect.origin.x + rect.size.w;
+    int16_t y1 = rect.origin.y + rect.size.h;
+    x1 = x1 > bounds.size.w ? bounds.size.w : x1;
+    y1 = y1 > bounds.size.h ? bounds.size.h : y1;
+    if (x1 <= x0 || y1 <= y0)
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return GRectZero;
+    }
+
+    // whole bytes are copied, so on 1-bit displays the restored area is
+    // widened to byte boundaries
+    int16_t first_byte = x0;
+    int16_t last_byte = x1 - 1;
+    if (gbitmap_get_format(frame_buffer) == GBitmapFormat1Bit)
+    {
+        first_byte = x0 / 8;
+        last_byte = (x1 - 1) / 8;
+        x0 = first_byte * 8;
+        x1 = (last_byte + 1) * 8;
+    }
+
+    const uint16_t fb_row = gbitmap_get_bytes_per_row(frame_buffer);
+    const uint16_t cache_row = gbitmap_get_bytes_per_row(bg_cache);
+    uint8_t *fb_data = gbitmap_get_data(frame_buffer);
+    const uint8_t *cache_data = gbitmap_get_data(bg_cache);
+    int16_t y;
+    for (y = y0; y < y1; ++y)
+    {
+        memcpy(fb_data + y * fb_row + first_byte, cache_data + y * cache_row + first_byte, last_byte - first_byte + 1);
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+#endif
+
+#if CIRCLOCK_SNAPSHOT
+
+const uint8_t *circlock_bg_cache_row(int16_t y)
+{
+    if (!bg_cache_valid || y < 0 || y >= gbitmap_get_bounds(bg_cache).size.h)
+    {
+        return NULL;
+    }
+    return (const uint8_t *)gbitmap_get_data(bg_cache) + y * gbitmap_get_bytes_per_row(bg_cache);
+}
+
+#endif
+
 void circlock_bg_init()
 {
+    bg_cache_valid = false;
+    full_redraw_pending = true;
 }
 
 void circlock_bg_deinit()
 {
+    if (bg_cache)
+    {
+        gbitmap_destroy(bg_cache);
+        bg_cache = NULL;
+    }
+    bg_cache_valid = false;
 }
-    
\ No newline at end of file
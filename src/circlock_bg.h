@@ -23,7 +23,26 @@
 #pragma once
 
 #include <pebble.h>
+
+#include "circlock_conf.h"
     
 extern void circlock_bg_update_proc(Layer *, GContext *);
+extern void circlock_bg_invalidate();
+extern void circlock_bg_request_full_redraw();
+extern bool circlock_bg_full_redraw_pending();
+extern bool circlock_bg_frame_is_full();
 extern void circlock_bg_init();
 extern void circlock_bg_deinit();
+
+// the background under the second hands is only put back by faces that
+// have them
+#if CIRCLOCK_FEATURE_SECONDS
+extern GRect circlock_bg_restore_rect(GContext *, GRect);
+#else
+#define circlock_bg_restore_rect(ctx, rect) GRectZero
+#endif
+
+#if CIRCLOCK_SNAPSHOT
+// a row of the cached background, NULL while there is none
+extern const uint8_t *circlock_bg_cache_row(int16_t y);
+#endif
@@ -22,19 +22,208 @@
 
 #pragma once
 
+// Every value in this file but the ring table can also be set on the
+// compiler command line, wscript builds its variants that way.
+
+// default face, the hand tables in flash are generated for it and any
+// other configuration sent over AppMessage is derived on the watch
+#ifndef CIRCLOCK_CLOCK_RADIUS
 #define CIRCLOCK_CLOCK_RADIUS 64
+#endif
 
+#ifndef CIRCLOCK_HAND_WIDTH
 #define CIRCLOCK_HAND_WIDTH 8
+#endif
+#ifndef CIRCLOCK_HAND_HEIGHT
 #define CIRCLOCK_HAND_HEIGHT 4
+#endif
+#ifndef CIRCLOCK_HAND_MARGIN
 #define CIRCLOCK_HAND_MARGIN 1
+#endif
 
-#define CIRCLOCK_CLOCK_CENTER_Y (CIRCLOCK_CLOCK_RADIUS + CIRCLOCK_HAND_HEIGHT)
-
+#ifndef CIRCLOCK_INVERT_COLORS
 #define CIRCLOCK_INVERT_COLORS 0
-#if defined(CIRCLOCK_INVERT_COLORS) && CIRCLOCK_INVERT_COLORS == 1
-#define CIRCLOCK_COLOR_FOREGROUND GColorBlack
-#define CIRCLOCK_COLOR_BACKGROUND GColorWhite
+#endif
+
+// what a build draws and which services it keeps running:
+// the second ring, ticking every second after a launch or tap
+#ifndef CIRCLOCK_FEATURE_SECONDS
+#define CIRCLOCK_FEATURE_SECONDS 1
+#endif
+// the battery gauge and the battery state service feeding it
+#ifndef CIRCLOCK_FEATURE_BATTERY
+#define CIRCLOCK_FEATURE_BATTERY 1
+#endif
+// the date label
+#ifndef CIRCLOCK_FEATURE_DATE
+#define CIRCLOCK_FEATURE_DATE 1
+#endif
+
+// the rings of the face from the outside in, each one bound to a unit of the
+// time, SECOND, MINUTE, HOUR, WDAY or MDAY, and split into steps positions of
+// its hand, ring radii follow from the radius, hand height and margin
+#if CIRCLOCK_FEATURE_SECONDS
+#define CIRCLOCK_RING_TABLE(RING) \
+    RING(SECOND, 60) \
+    RING(MINUTE, 60) \
+    RING(HOUR, 12 * 6)
 #else
-#define CIRCLOCK_COLOR_FOREGROUND GColorWhite
-#define CIRCLOCK_COLOR_BACKGROUND GColorBlack
+#define CIRCLOCK_RING_TABLE(RING) \
+    RING(MINUTE, 60) \
+    RING(HOUR, 12 * 6)
+#endif
+
+// accepted over AppMessage, the radius plus the hand height must leave
+// room for the labels and the battery gauge below the clock
+#ifndef CIRCLOCK_CONFIG_MIN_RADIUS
+#define CIRCLOCK_CONFIG_MIN_RADIUS 40
+#endif
+#ifndef CIRCLOCK_CONFIG_MAX_RADIUS
+#define CIRCLOCK_CONFIG_MAX_RADIUS 66
+#endif
+#ifndef CIRCLOCK_CONFIG_MAX_CENTER_Y
+#define CIRCLOCK_CONFIG_MAX_CENTER_Y 70
+#endif
+#ifndef CIRCLOCK_CONFIG_MIN_HAND_WIDTH
+#define CIRCLOCK_CONFIG_MIN_HAND_WIDTH 2
+#endif
+#ifndef CIRCLOCK_CONFIG_MAX_HAND_WIDTH
+#define CIRCLOCK_CONFIG_MAX_HAND_WIDTH 12
+#endif
+#ifndef CIRCLOCK_CONFIG_MIN_HAND_HEIGHT
+#define CIRCLOCK_CONFIG_MIN_HAND_HEIGHT 2
+#endif
+#ifndef CIRCLOCK_CONFIG_MAX_HAND_HEIGHT
+#define CIRCLOCK_CONFIG_MAX_HAND_HEIGHT 6
+#endif
+#ifndef CIRCLOCK_CONFIG_MAX_HAND_MARGIN
+#define CIRCLOCK_CONFIG_MAX_HAND_MARGIN 3
+#endif
+
+// log how long the background takes to rasterize versus to copy from cache
+#ifndef CIRCLOCK_BG_PROFILE
+#define CIRCLOCK_BG_PROFILE 0
+#endif
+
+// tick every second for this long after launch, then drop to minute ticks
+// and hide the second hand until the next tap or wrist flick
+#ifndef CIRCLOCK_POWER_IDLE_SECONDS
+#define CIRCLOCK_POWER_IDLE_SECONDS 60
+#endif
+#ifndef CIRCLOCK_POWER_GLANCE_SECONDS
+#define CIRCLOCK_POWER_GLANCE_SECONDS 30
+#endif
+
+// hours that stay at minute resolution even when tapped, equal start and
+// end hours disable the schedule
+#ifndef CIRCLOCK_POWER_QUIET_START_HOUR
+#define CIRCLOCK_POWER_QUIET_START_HOUR 23
+#endif
+#ifndef CIRCLOCK_POWER_QUIET_END_HOUR
+#define CIRCLOCK_POWER_QUIET_END_HOUR 7
+#endif
+
+// record the duration of every layer update proc into a ring buffer that is
+// dumped to the app log, or to DataLogging, when it fills up, on exit and
+// when the traceDump AppMessage key arrives
+#ifndef CIRCLOCK_TRACE
+#define CIRCLOCK_TRACE 0
+#endif
+#ifndef CIRCLOCK_TRACE_SAMPLES
+#define CIRCLOCK_TRACE_SAMPLES 128
+#endif
+#ifndef CIRCLOCK_TRACE_DUMP_WHEN_FULL
+#define CIRCLOCK_TRACE_DUMP_WHEN_FULL 1
+#endif
+#ifndef CIRCLOCK_TRACE_DATA_LOGGING
+#define CIRCLOCK_TRACE_DATA_LOGGING 0
+#endif
+
+// keep the changes of the battery charge in persistent storage, tagged with
+// the time spent in every tick mode, and log the drain per mode at launch,
+// on by default in builds with the battery gauge
+#ifndef CIRCLOCK_ENERGY
+#define CIRCLOCK_ENERGY CIRCLOCK_FEATURE_BATTERY
+#endif
+#ifndef CIRCLOCK_ENERGY_SAMPLES
+#define CIRCLOCK_ENERGY_SAMPLES 64
+#endif
+
+// keep the last full frame run-length coded in persistent storage and show
+// it as the first frame of the next launch, while the face starts up, when
+// it is at most CIRCLOCK_SNAPSHOT_MAX_AGE_SECONDS old
+#ifndef CIRCLOCK_SNAPSHOT
+#define CIRCLOCK_SNAPSHOT 1
+#endif
+#ifndef CIRCLOCK_SNAPSHOT_MAX_BYTES
+#define CIRCLOCK_SNAPSHOT_MAX_BYTES 1280
+#endif
+#ifndef CIRCLOCK_SNAPSHOT_MAX_AGE_SECONDS
+#define CIRCLOCK_SNAPSHOT_MAX_AGE_SECONDS 3600
+#endif
+// full frames are coded for the snapshot at most this often, the hands it
+// shows can be that far behind
+#ifndef CIRCLOCK_SNAPSHOT_INTERVAL_SECONDS
+#define CIRCLOCK_SNAPSHOT_INTERVAL_SECONDS 600
+#endif
+
+// blink rate of the charging indicator in the battery gauge
+#ifndef CIRCLOCK_BATTERY_CHARGING_FPS
+#define CIRCLOCK_BATTERY_CHARGING_FPS 2
+#endif
+
+// sweep the second hand in sub-second steps for a while after a glance,
+// frames may use CIRCLOCK_SWEEP_BUDGET_PERCENT of the frame period before
+// the rate is halved, and below CIRCLOCK_SWEEP_MIN_FPS the hand ticks again
+#ifndef CIRCLOCK_SWEEP
+#define CIRCLOCK_SWEEP 0
+#endif
+#ifndef CIRCLOCK_SWEEP_FPS
+#define CIRCLOCK_SWEEP_FPS 8
+#endif
+#ifndef CIRCLOCK_SWEEP_MIN_FPS
+#define CIRCLOCK_SWEEP_MIN_FPS 2
+#endif
+#ifndef CIRCLOCK_SWEEP_SECONDS
+#define CIRCLOCK_SWEEP_SECONDS 10
+#endif
+#ifndef CIRCLOCK_SWEEP_BUDGET_PERCENT
+#define CIRCLOCK_SWEEP_BUDGET_PERCENT 30
+#endif
+#ifndef CIRCLOCK_SWEEP_OVER_BUDGET_FRAMES
+#define CIRCLOCK_SWEEP_OVER_BUDGET_FRAMES 3
+#endif
+#ifndef CIRCLOCK_SWEEP_MIN_BATTERY_PERCENT
+#define CIRCLOCK_SWEEP_MIN_BATTERY_PERCENT 30
+#endif
+
+// skip frames and layers whose hand positions, battery segments, labels and
+// colors equal the ones the retained frame buffer already shows
+#ifndef CIRCLOCK_RENDER_DIFF
+#define CIRCLOCK_RENDER_DIFF 1
+#endif
+
+// fill the hands as sectors of their rings straight into the frame buffer
+// instead of as rotated rectangles with gpath_draw_filled
+#ifndef CIRCLOCK_HANDS_SECTORS
+#define CIRCLOCK_HANDS_SECTORS 1
+#endif
+
+// draw the whole face from one update proc on the root layer instead of a
+// tree of full-screen layers and text layers, nothing is allocated per layer
+#ifndef CIRCLOCK_COMPACT_RENDER
+#define CIRCLOCK_COMPACT_RENDER 0
+#endif
+
+// draw the labels from the bitmap fonts of tools/gen_glyph_atlas.py straight
+// into the frame buffer instead of laying out system font text
+#ifndef CIRCLOCK_GLYPH_LABELS
+#define CIRCLOCK_GLYPH_LABELS 0
+#endif
+
+#if CIRCLOCK_SWEEP && !CIRCLOCK_FEATURE_SECONDS
+#error "CIRCLOCK_SWEEP needs CIRCLOCK_FEATURE_SECONDS"
+#endif
+#if CIRCLOCK_ENERGY && !CIRCLOCK_FEATURE_BATTERY
+#error "CIRCLOCK_ENERGY needs CIRCLOCK_FEATURE_BATTERY"
 #endif
@@ -0,0 +1,120 @@
+// circlock_config.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_config.h"
+
+#include "circlock_trace.h"
+
+#define CONFIG_PERSIST_KEY 1
+#define CONFIG_PERSIST_VERSION 1
+#define CONFIG_INBOX_SIZE 64
+#define CONFIG_OUTBOX_SIZE 16
+
+typedef struct {
+    uint8_t version;
+    CirclockConfig config;
+} PersistedConfig;
+
+static CirclockConfigChangedHandler changed_handler = NULL;
+static CirclockConfig config;
+
+// integers arrive with whatever width the phone picked
+static int32_t tuple_int(const Tuple *tuple)
+{
+    if (tuple->type == TUPLE_INT)
+    {
+        return tuple->length == 1 ? tuple->value->int8
+             : tuple->length == 2 ? tuple->value->int16 : tuple->value->int32;
+    }
+    return tuple->length == 1 ? tuple->value->uint8
+         : tuple->length == 2 ? tuple->value->uint16 : (int32_t)tuple->value->uint32;
+}
+
+static void read_key(DictionaryIterator *iter, CirclockConfigKey key, uint8_t *value)
+{
+    const Tuple *tuple = dict_find(iter, key);
+    if (tuple && (tuple->type == TUPLE_INT || tuple->type == TUPLE_UINT))
+    {
+        const int32_t n = tuple_int(tuple);
+        *value = n < 0 ? 0 : n > UINT8_MAX ? UINT8_MAX : n;
+    }
+}
+
+static void handle_inbox_received(DictionaryIterator *iter, void *context)
+{
+    if (dict_find(iter, CIRCLOCK_CONFIG_KEY_TRACE_DUMP))
+    {
+        circlock_trace_dump();
+    }
+
+    CirclockConfig received = config;
+    uint8_t invert_colors = received.invert_colors;
+    read_key(iter, CIRCLOCK_CONFIG_KEY_CLOCK_RADIUS, &received.clock_radius);
+    read_key(iter, CIRCLOCK_CONFIG_KEY_HAND_WIDTH, &received.hand_width);
+    read_key(iter, CIRCLOCK_CONFIG_KEY_HAND_HEIGHT, &received.hand_height);
+    read_key(iter, CIRCLOCK_CONFIG_KEY_HAND_MARGIN, &received.hand_margin);
+    read_key(iter, CIRCLOCK_CONFIG_KEY_INVERT_COLORS, &invert_colors);
+    received.invert_colors = invert_colors != 0;
+
+    if (!circlock_geometry_config_valid(&received))
+    {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "config: ignored radius %u, hand %ux%u, margin %u",
+                received.clock_radius, received.hand_width, received.hand_height, received.hand_margin);
+        return;
+    }
+    if (memcmp(&received, &config, sizeof(CirclockConfig)) == 0)
+    {
+        return;
+    }
+    config = received;
+    const PersistedConfig persisted = { CONFIG_PERSIST_VERSION, config };
+    persist_write_data(CONFIG_PERSIST_KEY, &persisted, sizeof(persisted));
+    if (changed_handler)
+    {
+        changed_handler(&config);
+    }
+}
+
+const CirclockConfig *circlock_config()
+{
+    return &config;
+}
+
+void circlock_config_init(CirclockConfigChangedHandler handler)
+{
+    config = circlock_geometry_default_config();
+    PersistedConfig persisted;
+    if (persist_read_data(CONFIG_PERSIST_KEY, &persisted, sizeof(persisted)) == sizeof(persisted)
+        && persisted.version == CONFIG_PERSIST_VERSION && circlock_geometry_config_valid(&persisted.config))
+    {
+        config = persisted.config;
+    }
+    changed_handler = handler;
+    app_message_register_inbox_received(handle_inbox_received);
+    app_message_open(CONFIG_INBOX_SIZE, CONFIG_OUTBOX_SIZE);
+}
+
+void circlock_config_deinit()
+{
+    app_message_deregister_callbacks();
+    changed_handler = NULL;
+}
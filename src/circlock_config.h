@@ -0,0 +1,44 @@
+// circlock_config.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_geometry.h"
+
+// AppMessage keys, see appKeys in appinfo.json
+typedef enum {
+    CIRCLOCK_CONFIG_KEY_CLOCK_RADIUS = 0,
+    CIRCLOCK_CONFIG_KEY_HAND_WIDTH,
+    CIRCLOCK_CONFIG_KEY_HAND_HEIGHT,
+    CIRCLOCK_CONFIG_KEY_HAND_MARGIN,
+    CIRCLOCK_CONFIG_KEY_INVERT_COLORS,
+    // any value, dumps the trace ring of CIRCLOCK_TRACE builds
+    CIRCLOCK_CONFIG_KEY_TRACE_DUMP,
+} CirclockConfigKey;
+
+typedef void (*CirclockConfigChangedHandler)(const CirclockConfig *);
+
+extern const CirclockConfig *circlock_config();
+extern void circlock_config_init(CirclockConfigChangedHandler);
+extern void circlock_config_deinit();
@@ -0,0 +1,217 @@
+// circlock_energy.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_energy.h"
+
+#if CIRCLOCK_ENERGY
+
+#include "circlock_util.h"
+
+#define ENERGY_PERSIST_VERSION 1
+#define ENERGY_HEADER_KEY 0x200
+#define ENERGY_SAMPLES_KEY 0x201
+#define ENERGY_SAMPLES_PER_KEY ((uint16_t)(PERSIST_DATA_MAX_LENGTH / sizeof(CirclockEnergySample)))
+
+typedef struct {
+    uint8_t version;
+    uint8_t sample_size;
+    uint16_t capacity;
+    uint16_t head;
+    uint16_t count;
+} EnergyHeader;
+
+// ring of the latest samples, persisted at ENERGY_SAMPLES_KEY in chunks of
+// ENERGY_SAMPLES_PER_KEY so a new sample rewrites only its own chunk
+static CirclockEnergySample samples[CIRCLOCK_ENERGY_SAMPLES];
+static uint16_t sample_head = 0;
+static uint16_t sample_count = 0;
+
+// the charge the next sample is measured against
+static time_t last_time = 0;
+static uint8_t last_percent = 0;
+static bool last_charging = false;
+static bool launched = false;
+
+// time spent in every mode since the last sample
+static CirclockEnergyMode mode = CIRCLOCK_ENERGY_MODE_MINUTES;
+static time_t mode_since = 0;
+static uint32_t mode_seconds[CIRCLOCK_ENERGY_MODES];
+
+static uint16_t saturate(uint32_t value)
+{
+    return value > UINT16_MAX ? UINT16_MAX : value;
+}
+
+static bool is_charging(BatteryChargeState state)
+{
+    return state.is_charging || state.is_plugged;
+}
+
+static void account(time_t now)
+{
+    if (now > mode_since)
+    {
+        mode_seconds[mode] += now - mode_since;
+    }
+    mode_since = now;
+}
+
+// bytes of the chunk that starts at sample first
+static int chunk_size(uint16_t first)
+{
+    const uint16_t count = CIRCLOCK_ENERGY_SAMPLES - first < ENERGY_SAMPLES_PER_KEY
+        ? CIRCLOCK_ENERGY_SAMPLES - first : ENERGY_SAMPLES_PER_KEY;
+    return count * (int)sizeof(CirclockEnergySample);
+}
+
+static void save(uint16_t index)
+{
+    const EnergyHeader header = {
+        ENERGY_PERSIST_VERSION, sizeof(CirclockEnergySample), CIRCLOCK_ENERGY_SAMPLES, sample_head, sample_count
+    };
+    persist_write_data(ENERGY_HEADER_KEY, &header, sizeof(header));
+    const uint16_t chunk = index / ENERGY_SAMPLES_PER_KEY;
+    const uint16_t first = chunk * ENERGY_SAMPLES_PER_KEY;
+    persist_write_data(ENERGY_SAMPLES_KEY + chunk, &samples[first], chunk_size(first));
+}
+
+static void load()
+{
+    sample_head = 0;
+    sample_count = 0;
+    EnergyHeader header;
+    if (persist_read_data(ENERGY_HEADER_KEY, &header, sizeof(header)) != sizeof(header)
+        || header.version != ENERGY_PERSIST_VERSION || header.sample_size != sizeof(CirclockEnergySample)
+        || header.capacity != CIRCLOCK_ENERGY_SAMPLES || header.head >= CIRCLOCK_ENERGY_SAMPLES
+        || header.count > CIRCLOCK_ENERGY_SAMPLES)
+    {
+        return;
+    }
+    // until the ring is full it starts at the first sample, and the chunks
+    // past the last sample have not been written yet
+    uint16_t first;
+    for (first = 0; first < header.count; first += ENERGY_SAMPLES_PER_KEY)
+    {
+        const int size = chunk_size(first);
+        if (persist_read_data(ENERGY_SAMPLES_KEY + first / ENERGY_SAMPLES_PER_KEY, &samples[first], size) != size)
+        {
+            return;
+        }
+    }
+    sample_head = header.head;
+    sample_count = header.count;
+}
+
+void circlock_energy_set_mode(CirclockEnergyMode new_mode)
+{
+    if (new_mode == mode)
+    {
+        return;
+    }
+    account(time(NULL));
+    mode = new_mode;
+}
+
+void circlock_energy_battery_changed()
+{
+    const BatteryChargeState state = battery_state_service_peek();
+    if (state.charge_percent == last_percent && is_charging(state) == last_charging)
+    {
+        return;
+    }
+    const time_t now = time(NULL);
+    account(now);
+
+    const uint16_t index = (sample_head + sample_count) % CIRCLOCK_ENERGY_SAMPLES;
+    samples[index] = (CirclockEnergySample){
+        .minutes = saturate((now - last_time + 30) / 60),
+        .percent = (int8_t)(state.charge_percent - last_percent),
+        .flags = (is_charging(state) ? CIRCLOCK_ENERGY_FLAG_CHARGING : 0)
+            | (launched ? CIRCLOCK_ENERGY_FLAG_LAUNCH : 0)
+            | (CIRCLOCK_COMPACT_RENDER ? CIRCLOCK_ENERGY_FLAG_COMPACT : 0),
+        .seconds_mode_s = saturate(mode_seconds[CIRCLOCK_ENERGY_MODE_SECONDS]),
+        .sweep_mode_s = saturate(mode_seconds[CIRCLOCK_ENERGY_MODE_SWEEP]),
+    };
+    if (sample_count < CIRCLOCK_ENERGY_SAMPLES)
+    {
+        ++sample_count;
+    }
+    else
+    {
+        sample_head = (sample_head + 1) % CIRCLOCK_ENERGY_SAMPLES;
+    }
+    save(index);
+
+    last_time = now;
+    last_percent = state.charge_percent;
+    last_charging = is_charging(state);
+    launched = false;
+    memset(mode_seconds, 0, sizeof(mode_seconds));
+}
+
+_Static_assert(CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES % sizeof(CirclockEnergySample) == 0,
+               "energy samples must not be split over log lines");
+
+static void dump_run(const CirclockEnergySample *run, uint16_t run_count)
+{
+    circlock_util_log_hex("energy:", run, run_count * sizeof(CirclockEnergySample));
+}
+
+// logs the samples oldest first, tools/energy_report.py fits the drain of
+// every mode to them off the watch
+void circlock_energy_dump()
+{
+    const uint16_t first = CIRCLOCK_ENERGY_SAMPLES - sample_head < sample_count
+        ? CIRCLOCK_ENERGY_SAMPLES - sample_head : sample_count;
+    if (first > 0)
+    {
+        dump_run(&samples[sample_head], first);
+    }
+    if (sample_count > first)
+    {
+        dump_run(samples, sample_count - first);
+    }
+    APP_LOG(APP_LOG_LEVEL_INFO, "energy: %u samples", (unsigned)sample_count);
+}
+
+void circlock_energy_init()
+{
+    load();
+    const BatteryChargeState state = battery_state_service_peek();
+    last_time = time(NULL);
+    last_percent = state.charge_percent;
+    last_charging = is_charging(state);
+    launched = true;
+    mode = CIRCLOCK_ENERGY_MODE_MINUTES;
+    mode_since = last_time;
+    memset(mode_seconds, 0, sizeof(mode_seconds));
+    circlock_energy_dump();
+}
+
+void circlock_energy_deinit()
+{
+    // the interval since the last sample has no charge change to measure
+    // against, it is dropped
+    memset(mode_seconds, 0, sizeof(mode_seconds));
+}
+
+#endif
@@ -0,0 +1,72 @@
+// circlock_energy.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+
+// what the face spent its time doing between two battery samples
+typedef enum {
+    CIRCLOCK_ENERGY_MODE_MINUTES = 0,
+    CIRCLOCK_ENERGY_MODE_SECONDS,
+    CIRCLOCK_ENERGY_MODE_SWEEP,
+    CIRCLOCK_ENERGY_MODES,
+} CirclockEnergyMode;
+
+// the charger was connected when the sample was taken
+#define CIRCLOCK_ENERGY_FLAG_CHARGING 0x01
+// first sample since launch, the interval does not start at a charge change
+#define CIRCLOCK_ENERGY_FLAG_LAUNCH 0x02
+// taken by a build with CIRCLOCK_COMPACT_RENDER
+#define CIRCLOCK_ENERGY_FLAG_COMPACT 0x04
+
+// Persisted and dump format: little-endian samples of 8 bytes, taken on
+// every change of the charge or of the charger and delta encoded against
+// the previous sample. The time not spent in the other modes was spent in
+// CIRCLOCK_ENERGY_MODE_MINUTES. tools/energy_report.py decodes the dump.
+typedef struct __attribute__((__packed__)) {
+    uint16_t minutes;
+    int8_t percent;
+    uint8_t flags;
+    uint16_t seconds_mode_s;
+    uint16_t sweep_mode_s;
+} CirclockEnergySample;
+
+#if CIRCLOCK_ENERGY
+
+extern void circlock_energy_set_mode(CirclockEnergyMode);
+extern void circlock_energy_battery_changed();
+extern void circlock_energy_dump();
+extern void circlock_energy_init();
+extern void circlock_energy_deinit();
+
+#else
+
+#define circlock_energy_set_mode(mode)
+#define circlock_energy_battery_changed()
+#define circlock_energy_dump()
+#define circlock_energy_init()
+#define circlock_energy_deinit()
+
+#endif
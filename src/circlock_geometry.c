@@ -0,0 +1,331 @@
+// circlock_geometry.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_geometry.h"
+
+#include "circlock_conf.h"
+
+// the default configuration, generated by tools/gen_hand_tables.py
+#include "circlock_hands_table.h"
+
+// the rows of RING_ROW_EXTENTS must be those of the default layout,
+// ring_rows in compute_layout()
+#if CIRCLOCK_HAND_TABLE_POINTS != CIRCLOCK_HAND_POINTS || CIRCLOCK_HAND_TABLE_RINGS != CIRCLOCK_RINGS \
+    || CIRCLOCK_HAND_TABLE_STEPS != CIRCLOCK_RING_STEPS \
+    || CIRCLOCK_RING_ROWS != CIRCLOCK_CLOCK_RADIUS + 2 * CIRCLOCK_HAND_MARGIN + 1
+#error "circlock_hands_table.h does not match circlock_geometry.h"
+#endif
+
+#define GEOMETRY_CACHE_VERSION 2
+#define GEOMETRY_CACHE_KEY 0x100
+#define RING_ROWS_MAX (CIRCLOCK_CONFIG_MAX_RADIUS + 2 * CIRCLOCK_CONFIG_MAX_HAND_MARGIN + 1)
+
+// Geometry of any configuration but the default one, derived on the watch.
+// It is persisted in chunks of PERSIST_DATA_MAX_LENGTH at consecutive keys
+// from GEOMETRY_CACHE_KEY, so a cold start only reads it back.
+typedef struct {
+    uint8_t version;
+    uint16_t size;
+    CirclockConfig config;
+    GSize screen;
+    CirclockLayout layout;
+    CirclockHandPoints hands[CIRCLOCK_RING_STEPS];
+    int8_t ring_extents[CIRCLOCK_RINGS * RING_ROWS_MAX][2];
+} GeometryCache;
+
+#define GEOMETRY_CACHE_CHUNKS ((sizeof(GeometryCache) + PERSIST_DATA_MAX_LENGTH - 1) / PERSIST_DATA_MAX_LENGTH)
+
+#define RING_INFO(unit, steps) { CIRCLOCK_UNIT_##unit, steps },
+
+const CirclockRing circlock_rings[CIRCLOCK_RINGS] = {
+    CIRCLOCK_RING_TABLE(RING_INFO)
+};
+
+static CirclockGeometry geometry;
+static GeometryCache *cache = NULL;
+
+static bool config_equal(const CirclockConfig *a, const CirclockConfig *b)
+{
+    return a->clock_radius == b->clock_radius && a->hand_width == b->hand_width
+        && a->hand_height == b->hand_height && a->hand_margin == b->hand_margin
+        && a->invert_colors == b->invert_colors;
+}
+
+// y of the middle of each hand, from the outermost ring in
+static int16_t hand_y(const CirclockConfig *config, uint8_t ring)
+{
+    return config->clock_radius + config->hand_margin - ring * (config->hand_height + config->hand_margin);
+}
+
+// the hand of a ring before rotation, pointing down from the center
+static void hand_shape(const CirclockConfig *config, const CirclockLayout *layout, uint8_t ring,
+                       CirclockHandPoints points)
+{
+    const int8_t half = config->hand_width / 2;
+    points[0][0] = -half;
+    points[0][1] = layout->ring_radii[ring][1];
+    points[1][0] = half;
+    points[1][1] = layout->ring_radii[ring][1];
+    points[2][0] = half;
+    points[2][1] = layout->ring_radii[ring][0];
+    points[3][0] = -half;
+    points[3][1] = layout->ring_radii[ring][0];
+}
+
+static void compute_layout(GSize screen, const CirclockConfig *config, CirclockLayout *layout)
+{
+    layout->foreground = config->invert_colors ? GColorBlack : GColorWhite;
+    layout->background = config->invert_colors ? GColorWhite : GColorBlack;
+
+    const int16_t center_y = config->clock_radius + config->hand_height;
+    layout->center = (GPoint){ screen.w / 2, center_y };
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        const int16_t y = hand_y(config, ring);
+        layout->ring_radii[ring][0] = y - config->hand_height - config->hand_margin;
+        layout->ring_radii[ring][1] = y + config->hand_margin;
+    }
+    layout->ring_rows = layout->ring_radii[0][1] + 1;
+
+    layout->separator_y = 2 * center_y;
+    const int16_t date_width = 80;
+    layout->date_rect = GRect(layout->center.x - date_width / 2, 2 * center_y + 2, date_width, 20);
+    layout->time_rect = GRect(10, center_y - 10, screen.w - 20, 20);
+    const int16_t battery_top = 2 * center_y + 20;
+    layout->battery_rect = GRect(0, battery_top, screen.w, screen.h - battery_top);
+}
+
+// the same per-term transform the generator and gpath_rotate_to() apply
+static void rotate_hand(const CirclockHandPoints shape, int32_t angle, CirclockHandPoints points)
+{
+    const int32_t sine = sin_lookup(angle);
+    const int32_t cosine = cos_lookup(angle);
+    uint8_t i;
+    for (i = 0; i < CIRCLOCK_HAND_POINTS; ++i)
+    {
+        const int32_t x = shape[i][0];
+        const int32_t y = shape[i][1];
+        points[i][0] = x * cosine / TRIG_MAX_RATIO - y * sine / TRIG_MAX_RATIO;
+        points[i][1] = y * cosine / TRIG_MAX_RATIO + x * sine / TRIG_MAX_RATIO;
+    }
+}
+
+static int16_t isqrt(int32_t n)
+{
+    int32_t root = 0;
+    int32_t bit = 1 << 14;
+    while (bit > 0)
+    {
+        if ((root + bit) * (root + bit) <= n)
+        {
+            root += bit;
+        }
+        bit >>= 1;
+    }
+    return root;
+}
+
+static void derive_tables(GeometryCache *derived)
+{
+    const CirclockConfig *config = &derived->config;
+    CirclockHandPoints *hand = derived->hands;
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        CirclockHandPoints shape;
+        hand_shape(config, &derived->layout, ring, shape);
+        uint8_t step;
+        for (step = 0; step < circlock_rings[ring].steps; ++step)
+        {
+            rotate_hand(shape, circlock_geometry_ring_angle(ring, step), *hand++);
+        }
+    }
+
+    const uint8_t rows = derived->layout.ring_rows;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        const int32_t inner = derived->layout.ring_radii[ring][0];
+        const int32_t outer = derived->layout.ring_radii[ring][1];
+        int32_t dy;
+        for (dy = 0; dy < rows; ++dy)
+        {
+            int8_t *extent = derived->ring_extents[ring * rows + dy];
+            extent[0] = dy < inner ? isqrt(inner * inner - dy * dy - 1) : -1;
+            extent[1] = dy <= outer ? isqrt(outer * outer - dy * dy) : -1;
+        }
+    }
+}
+
+static bool load_cache(GeometryCache *loaded, GSize screen, const CirclockConfig *config)
+{
+    uint8_t *bytes = (uint8_t *)loaded;
+    uint16_t chunk;
+    for (chunk = 0; chunk < GEOMETRY_CACHE_CHUNKS; ++chunk)
+    {
+        const size_t offset = chunk * PERSIST_DATA_MAX_LENGTH;
+        const size_t size = sizeof(GeometryCache) - offset < PERSIST_DATA_MAX_LENGTH
+            ? sizeof(GeometryCache) - offset : PERSIST_DATA_MAX_LENGTH;
+        if (persist_read_data(GEOMETRY_CACHE_KEY + chunk, bytes + offset, size) != (int)size)
+        {
+            return false;
+        }
+        // the first chunk tells whether the rest is worth reading
+        if (chunk == 0 && (loaded->version != GEOMETRY_CACHE_VERSION || loaded->size != sizeof(GeometryCache)
+            || !config_equal(&loaded->config, config) || loaded->screen.w != screen.w || loaded->screen.h != screen.h))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void save_cache(const GeometryCache *derived)
+{
+    const uint8_t *bytes = (const uint8_t *)derived;
+    uint16_t chunk;
+    for (chunk = 0; chunk < GEOMETRY_CACHE_CHUNKS; ++chunk)
+    {
+        const size_t offset = chunk * PERSIST_DATA_MAX_LENGTH;
+        const size_t size = sizeof(GeometryCache) - offset < PERSIST_DATA_MAX_LENGTH
+            ? sizeof(GeometryCache) - offset : PERSIST_DATA_MAX_LENGTH;
+        const int written = persist_write_data(GEOMETRY_CACHE_KEY + chunk, bytes + offset, size);
+        if (written != (int)size)
+        {
+            APP_LOG(APP_LOG_LEVEL_WARNING, "geometry: cannot persist chunk %u (%d)", chunk, written);
+            return;
+        }
+    }
+}
+
+static void delete_cache()
+{
+    uint16_t chunk;
+    for (chunk = 0; chunk < GEOMETRY_CACHE_CHUNKS; ++chunk)
+    {
+        persist_delete(GEOMETRY_CACHE_KEY + chunk);
+    }
+}
+
+// the rings' positions follow each other in a hand table
+static void set_hands(const CirclockHandPoints *table)
+{
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        geometry.hands[ring] = table;
+        table += circlock_rings[ring].steps;
+    }
+}
+
+static void use_default(GSize screen)
+{
+    geometry.config = circlock_geometry_default_config();
+    compute_layout(screen, &geometry.config, &geometry.layout);
+    set_hands(HAND_TABLE);
+    geometry.ring_extents = &RING_ROW_EXTENTS[0][0];
+}
+
+CirclockConfig circlock_geometry_default_config()
+{
+    return (CirclockConfig){
+        .clock_radius = CIRCLOCK_CLOCK_RADIUS,
+        .hand_width = CIRCLOCK_HAND_WIDTH,
+        .hand_height = CIRCLOCK_HAND_HEIGHT,
+        .hand_margin = CIRCLOCK_HAND_MARGIN,
+        .invert_colors = CIRCLOCK_INVERT_COLORS,
+    };
+}
+
+bool circlock_geometry_config_valid(const CirclockConfig *config)
+{
+    return config->clock_radius >= CIRCLOCK_CONFIG_MIN_RADIUS && config->clock_radius <= CIRCLOCK_CONFIG_MAX_RADIUS
+        && config->clock_radius + config->hand_height <= CIRCLOCK_CONFIG_MAX_CENTER_Y
+        && config->hand_width >= CIRCLOCK_CONFIG_MIN_HAND_WIDTH && config->hand_width <= CIRCLOCK_CONFIG_MAX_HAND_WIDTH
+        && config->hand_height >= CIRCLOCK_CONFIG_MIN_HAND_HEIGHT && config->hand_height <= CIRCLOCK_CONFIG_MAX_HAND_HEIGHT
+        && config->hand_margin <= CIRCLOCK_CONFIG_MAX_HAND_MARGIN
+        && hand_y(config, CIRCLOCK_RINGS - 1) - config->hand_height - config->hand_margin > 0;
+}
+
+const CirclockGeometry *circlock_geometry()
+{
+    return &geometry;
+}
+
+int32_t circlock_geometry_ring_angle(uint8_t ring, uint8_t step)
+{
+    return TRIG_MAX_ANGLE * step / circlock_rings[ring].steps + TRIG_MAX_ANGLE / 2;
+}
+
+void circlock_geometry_init(GSize screen, const CirclockConfig *config)
+{
+    const CirclockConfig default_config = circlock_geometry_default_config();
+    if (config_equal(config, &default_config) || !circlock_geometry_config_valid(config))
+    {
+        if (cache)
+        {
+            free(cache);
+            cache = NULL;
+        }
+        if (persist_exists(GEOMETRY_CACHE_KEY))
+        {
+            delete_cache();
+        }
+        use_default(screen);
+        return;
+    }
+
+    if (!cache)
+    {
+        cache = malloc(sizeof(GeometryCache));
+        if (!cache)
+        {
+            APP_LOG(APP_LOG_LEVEL_ERROR, "geometry: no memory for a %u byte cache", (unsigned)sizeof(GeometryCache));
+            use_default(screen);
+            return;
+        }
+    }
+    if (!load_cache(cache, screen, config))
+    {
+        memset(cache, 0, sizeof(GeometryCache));
+        cache->version = GEOMETRY_CACHE_VERSION;
+        cache->size = sizeof(GeometryCache);
+        cache->config = *config;
+        cache->screen = screen;
+        compute_layout(screen, config, &cache->layout);
+        derive_tables(cache);
+        save_cache(cache);
+    }
+    geometry.config = cache->config;
+    geometry.layout = cache->layout;
+    set_hands(cache->hands);
+    geometry.ring_extents = cache->ring_extents;
+}
+
+void circlock_geometry_deinit()
+{
+    if (cache)
+    {
+        free(cache);
+        cache = NULL;
+    }
+}
@@ -0,0 +1,96 @@
+// circlock_geometry.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+
+#define CIRCLOCK_HAND_POINTS 4
+
+#define CIRCLOCK_RING_COUNT(unit, steps) + 1
+#define CIRCLOCK_RING_STEP_COUNT(unit, steps) + (steps)
+#define CIRCLOCK_RINGS (0 CIRCLOCK_RING_TABLE(CIRCLOCK_RING_COUNT))
+// hand positions of all rings together
+#define CIRCLOCK_RING_STEPS (0 CIRCLOCK_RING_TABLE(CIRCLOCK_RING_STEP_COUNT))
+
+typedef enum {
+    CIRCLOCK_UNIT_SECOND = 0,
+    CIRCLOCK_UNIT_MINUTE,
+    CIRCLOCK_UNIT_HOUR,
+    CIRCLOCK_UNIT_WDAY,
+    CIRCLOCK_UNIT_MDAY,
+} CirclockUnit;
+
+// a ring of CIRCLOCK_RING_TABLE, the hand of step 0 points up and the steps
+// go round clockwise
+typedef struct {
+    uint8_t unit;
+    uint8_t steps;
+} CirclockRing;
+
+typedef struct {
+    uint8_t clock_radius;
+    uint8_t hand_width;
+    uint8_t hand_height;
+    uint8_t hand_margin;
+    bool invert_colors;
+} CirclockConfig;
+
+typedef int8_t CirclockHandPoints[CIRCLOCK_HAND_POINTS][2];
+
+// everything placed on the screen that follows from a CirclockConfig
+typedef struct {
+    GColor foreground;
+    GColor background;
+    GPoint center;
+    // radii of the hand ends on every ring
+    uint8_t ring_radii[CIRCLOCK_RINGS][2];
+    // rows of every ring in ring_extents
+    uint8_t ring_rows;
+    int16_t separator_y;
+    GRect date_rect;
+    GRect time_rect;
+    GRect battery_rect;
+} CirclockLayout;
+
+typedef struct {
+    CirclockConfig config;
+    CirclockLayout layout;
+    // hand corners for every position of every ring, relative to the center
+    const CirclockHandPoints *hands[CIRCLOCK_RINGS];
+    // per row from the center: widest x inside the hole of a ring (-1 below
+    // it) and widest x inside its outer circle (-1 past it), row y of ring r
+    // at [r * ring_rows + y]
+    const int8_t (*ring_extents)[2];
+} CirclockGeometry;
+
+extern const CirclockRing circlock_rings[CIRCLOCK_RINGS];
+
+extern CirclockConfig circlock_geometry_default_config();
+extern bool circlock_geometry_config_valid(const CirclockConfig *);
+extern const CirclockGeometry *circlock_geometry();
+// rotation of the hand of a ring at a step, the hand tables are built for it
+extern int32_t circlock_geometry_ring_angle(uint8_t ring, uint8_t step);
+extern void circlock_geometry_init(GSize screen, const CirclockConfig *);
+extern void circlock_geometry_deinit();
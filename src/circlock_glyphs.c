@@ -0,0 +1,141 @@
+// circlock_glyphs.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_glyphs.h"
+
+#if CIRCLOCK_GLYPH_LABELS
+
+// fixed-width bitmap fonts for the labels, generated at build time by
+// tools/gen_glyph_atlas.py
+#include "circlock_glyph_atlas.h"
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t advance;
+    const int8_t *index;
+    const uint16_t *rows;
+} GlyphAtlas;
+
+static const GlyphAtlas ATLASES[] = {
+    [CIRCLOCK_GLYPHS_TIME] = {
+        CIRCLOCK_GLYPH_TIME_WIDTH, CIRCLOCK_GLYPH_TIME_HEIGHT, CIRCLOCK_GLYPH_TIME_ADVANCE,
+        TIME_GLYPH_INDEX, &TIME_GLYPHS[0][0]
+    },
+    [CIRCLOCK_GLYPHS_DATE] = {
+        CIRCLOCK_GLYPH_DATE_WIDTH, CIRCLOCK_GLYPH_DATE_HEIGHT, CIRCLOCK_GLYPH_DATE_ADVANCE,
+        DATE_GLYPH_INDEX, &DATE_GLYPHS[0][0]
+    },
+};
+
+static const uint16_t *glyph(const GlyphAtlas *atlas, char c)
+{
+    if (c < ' ' || c - ' ' >= 96 || atlas->index[c - ' '] < 0)
+    {
+        return NULL;
+    }
+    return atlas->rows + atlas->index[c - ' '] * atlas->height;
+}
+
+// whether the atlas holds every character of text, spaces only advance
+static bool covers(const GlyphAtlas *atlas, const char *text)
+{
+    for (; *text; ++text)
+    {
+        if (*text != ' ' && !glyph(atlas, *text))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ors or clears the rows of one glyph into the frame buffer at byte-unaligned x
+static void blit(uint8_t *data, uint16_t row_bytes, const uint16_t *rows, uint8_t height, int16_t x, int16_t y, bool set)
+{
+    uint8_t *line = data + y * row_bytes + x / 8;
+    const uint8_t shift = x % 8;
+    uint8_t i;
+    for (i = 0; i < height; ++i, line += row_bytes)
+    {
+        const uint32_t bits = (uint32_t)rows[i] << shift;
+        if (!bits)
+        {
+            continue;
+        }
+        uint8_t k;
+        for (k = 0; k < 3 && (bits >> (8 * k)); ++k)
+        {
+            const uint8_t mask = bits >> (8 * k);
+            line[k] = set ? line[k] | mask : line[k] & ~mask;
+        }
+    }
+}
+
+bool circlock_glyphs_draw(Layer *layer, GContext *ctx, CirclockGlyphFont font, const char *text, GRect rect, GColor color)
+{
+    const GlyphAtlas *atlas = &ATLASES[font];
+    if (!covers(atlas, text))
+    {
+        return false;
+    }
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        return false;
+    }
+    const GRect bounds = gbitmap_get_bounds(frame_buffer);
+    const GRect frame = layer_get_frame(layer);
+    if (gbitmap_get_format(frame_buffer) != GBitmapFormat1Bit
+        || frame.origin.x != bounds.origin.x || frame.origin.y != bounds.origin.y
+        || frame.size.w != bounds.size.w || frame.size.h != bounds.size.h)
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return false;
+    }
+
+    const int16_t width = strlen(text) * atlas->advance - (atlas->advance - atlas->width);
+    int16_t x = rect.origin.x + (rect.size.w - width) / 2;
+    const int16_t y = rect.origin.y + (rect.size.h - atlas->height) / 2;
+    // glyphs are not clipped, text that would leave the screen is laid out
+    // by the caller instead
+    if (x < 0 || x + width > bounds.size.w || y < 0 || y + atlas->height > bounds.size.h)
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return false;
+    }
+    const uint16_t row_bytes = gbitmap_get_bytes_per_row(frame_buffer);
+    uint8_t *data = gbitmap_get_data(frame_buffer);
+    const bool set = color == GColorWhite;
+    for (; *text; ++text, x += atlas->advance)
+    {
+        const uint16_t *rows = glyph(atlas, *text);
+        if (rows)
+        {
+            blit(data, row_bytes, rows, atlas->height, x, y, set);
+        }
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return true;
+}
+
+#endif
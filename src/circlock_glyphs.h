@@ -0,0 +1,43 @@
+// circlock_glyphs.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+
+typedef enum {
+    CIRCLOCK_GLYPHS_TIME = 0,
+    CIRCLOCK_GLYPHS_DATE,
+} CirclockGlyphFont;
+
+#if CIRCLOCK_GLYPH_LABELS
+
+// Blits text centered into rect straight into the frame buffer, from the
+// atlases generated by tools/gen_glyph_atlas.py. Returns false, having
+// drawn nothing, when the atlas lacks a character of text other than a
+// space, when the text would leave the screen, or when the layer does not
+// cover a 1-bit frame buffer, so the caller can draw it as text instead.
+extern bool circlock_glyphs_draw(Layer *, GContext *, CirclockGlyphFont, const char *text, GRect rect, GColor);
+
+#endif
@@ -23,86 +23,269 @@
 #include "circlock_hands.h"
 
 #include "circlock_conf.h"
+#include "circlock_bg.h"
+#include "circlock_sector.h"
+#include "circlock_geometry.h"
+#include "circlock_render.h"
 
-static GPath *second_hand;
-static GPath *minute_hand;
-static GPath *hour_hand;
+// table steps of the current time on every ring, see circlock_hands_set_time()
+static uint8_t ring_steps[CIRCLOCK_RINGS];
+static uint8_t second = 0;
 
-#define CIRCLOCK_SECOND_HAND_POINT_Y (CIRCLOCK_CLOCK_RADIUS + CIRCLOCK_HAND_MARGIN)
-static const GPathInfo SECOND_HAND_POINTS =
+// milliseconds into the current second while the second hands sweep, zero
+// when they sit on a table position
+static uint16_t second_millis = 0;
+
+// screen area covered by the hands of the second rings drawn in the previous
+// frame
+static GRect second_hand_rects[CIRCLOCK_RINGS];
+static bool second_hands_drawn = false;
+static bool second_hands_visible = true;
+
+// the positions the frame buffer shows, a patch frame that would draw the
+// same ones leaves it alone
+static CirclockHandsState drawn_state;
+static bool drawn_state_valid = false;
+
+// constant without CIRCLOCK_FEATURE_SECONDS, the second hand code drops out
+static bool ticks_seconds(uint8_t ring)
+{
+#if CIRCLOCK_FEATURE_SECONDS
+    return circlock_rings[ring].unit == CIRCLOCK_UNIT_SECOND;
+#else
+    return false;
+#endif
+}
+
+// the step of a ring at a time
+static uint8_t time_step(uint8_t ring, const struct tm *t)
 {
-    .num_points = 4,
-    .points = (GPoint []) {
-        {-CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_SECOND_HAND_POINT_Y + CIRCLOCK_HAND_MARGIN},
-        { CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_SECOND_HAND_POINT_Y + CIRCLOCK_HAND_MARGIN},
-        { CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_SECOND_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN},
-        {-CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_SECOND_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN}
+    const int32_t steps = circlock_rings[ring].steps;
+    switch (circlock_rings[ring].unit)
+    {
+    case CIRCLOCK_UNIT_SECOND:
+        return t->tm_sec % 60 * steps / 60;
+    case CIRCLOCK_UNIT_MINUTE:
+        return t->tm_min * steps / 60;
+    case CIRCLOCK_UNIT_HOUR:
+        return ((t->tm_hour % 12) * 60 + t->tm_min) * steps / (12 * 60);
+    case CIRCLOCK_UNIT_WDAY:
+        return t->tm_wday * steps / 7;
+    default:
+        return (t->tm_mday - 1) * steps / 31;
     }
-};
+}
 
-#define CIRCLOCK_MINUTE_HAND_POINT_Y (CIRCLOCK_SECOND_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN)
-static const GPathInfo MINUTE_HAND_POINTS =
+// the angle the hand tables are generated for, or while sweeping the angle
+// of the second the hands of second rings are at
+static int32_t hand_angle(uint8_t ring)
 {
-    .num_points = 4,
-    .points = (GPoint []) {
-        {-CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_MINUTE_HAND_POINT_Y + CIRCLOCK_HAND_MARGIN},
-        { CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_MINUTE_HAND_POINT_Y + CIRCLOCK_HAND_MARGIN},
-        { CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_MINUTE_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN},
-        {-CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_MINUTE_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN}
+    if (CIRCLOCK_SWEEP && second_millis && ticks_seconds(ring))
+    {
+        // TRIG_MAX_ANGLE / 60000 reduced by 4, the full product overflows
+        return (TRIG_MAX_ANGLE / 4) * ((int32_t)second * 1000 + second_millis + 30000) / 15000;
     }
-};
+    return circlock_geometry_ring_angle(ring, ring_steps[ring]);
+}
 
-#define CIRCLOCK_HOUR_HAND_POINT_Y (CIRCLOCK_MINUTE_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN)
-static const GPathInfo HOUR_HAND_POINTS = 
+static void hand_points(uint8_t ring, GPoint points[CIRCLOCK_HAND_POINTS])
 {
-    .num_points = 4,
-    .points = (GPoint []) {
-        {-CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_HOUR_HAND_POINT_Y + CIRCLOCK_HAND_MARGIN},
-        { CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_HOUR_HAND_POINT_Y + CIRCLOCK_HAND_MARGIN},
-        { CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_HOUR_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN},
-        {-CIRCLOCK_HAND_WIDTH / 2, CIRCLOCK_HOUR_HAND_POINT_Y - CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_MARGIN}
+    const CirclockGeometry *geometry = circlock_geometry();
+    const GPoint center = geometry->layout.center;
+    uint8_t i;
+    if (!CIRCLOCK_SWEEP || !second_millis || !ticks_seconds(ring))
+    {
+        const CirclockHandPoints *table = &geometry->hands[ring][ring_steps[ring]];
+        for (i = 0; i < CIRCLOCK_HAND_POINTS; ++i)
+        {
+            points[i] = (GPoint){ center.x + (*table)[i][0], center.y + (*table)[i][1] };
+        }
+        return;
+    }
+
+    // positions between the table steps are rotated at runtime
+    const int32_t angle = hand_angle(ring);
+    const int32_t sine = sin_lookup(angle);
+    const int32_t cosine = cos_lookup(angle);
+    const int32_t half = geometry->config.hand_width / 2;
+    const uint8_t *radii = geometry->layout.ring_radii[ring];
+    const int32_t shape[CIRCLOCK_HAND_POINTS][2] = {
+        { -half, radii[1] }, { half, radii[1] }, { half, radii[0] }, { -half, radii[0] }
+    };
+    for (i = 0; i < CIRCLOCK_HAND_POINTS; ++i)
+    {
+        const int32_t x = shape[i][0];
+        const int32_t y = shape[i][1];
+        points[i] = (GPoint){
+            center.x + x * cosine / TRIG_MAX_RATIO - y * sine / TRIG_MAX_RATIO,
+            center.y + y * cosine / TRIG_MAX_RATIO + x * sine / TRIG_MAX_RATIO
+        };
     }
-};
+}
+
+static GRect hand_bounds(const GPoint points[CIRCLOCK_HAND_POINTS])
+{
+    int16_t min_x = INT16_MAX, min_y = INT16_MAX;
+    int16_t max_x = INT16_MIN, max_y = INT16_MIN;
+    uint8_t i;
+    for (i = 0; i < CIRCLOCK_HAND_POINTS; ++i)
+    {
+        min_x = points[i].x < min_x ? points[i].x : min_x;
+        min_y = points[i].y < min_y ? points[i].y : min_y;
+        max_x = points[i].x > max_x ? points[i].x : max_x;
+        max_y = points[i].y > max_y ? points[i].y : max_y;
+    }
+    // one pixel of slack for the rounding of the path filler
+    return GRect(min_x - 1, min_y - 1, max_x - min_x + 3, max_y - min_y + 3);
+}
+
+static bool rects_intersect(GRect a, GRect b)
+{
+    return a.origin.x < b.origin.x + b.size.w && b.origin.x < a.origin.x + a.size.w
+        && a.origin.y < b.origin.y + b.size.h && b.origin.y < a.origin.y + a.size.h;
+}
+
+// Cuts a hand out of its ring. Without a frame buffer that can be written
+// directly the hand is filled as the path of its corners.
+static void draw_hand(GContext *ctx, GBitmap *frame_buffer, uint8_t ring, GPoint points[CIRCLOCK_HAND_POINTS])
+{
+    if (frame_buffer)
+    {
+        const CirclockLayout *layout = &circlock_geometry()->layout;
+        circlock_sector_fill(frame_buffer, layout->center, ring, hand_angle(ring), hand_bounds(points),
+                             layout->background);
+        return;
+    }
+    GPath path = {
+        .num_points = CIRCLOCK_HAND_POINTS,
+        .points = points,
+        .rotation = 0,
+        .offset = GPointZero
+    };
+    gpath_draw_filled(ctx, &path);
+}
 
 void circlock_hands_update_proc(Layer *layer, GContext *ctx)
 {
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-
-    // second/minute/hour hands
-    gpath_rotate_to(second_hand, TRIG_MAX_ANGLE * (t->tm_sec + 30) / 60);
-    gpath_rotate_to(minute_hand, TRIG_MAX_ANGLE * (t->tm_min + 30) / 60);
-    gpath_rotate_to(hour_hand, (TRIG_MAX_ANGLE * (((t->tm_hour % 12) * 6) + (t->tm_min / 10))) / (12 * 6) + TRIG_MAX_ANGLE / 2);
-    
-    graphics_context_set_fill_color(ctx, CIRCLOCK_COLOR_BACKGROUND);
-    gpath_draw_filled(ctx, second_hand);
-    gpath_draw_filled(ctx, minute_hand);
-    gpath_draw_filled(ctx, hour_hand);
-    
-//     graphics_context_set_stroke_color(ctx, CIRCLOCK_COLOR_FOREGROUND);
-//     gpath_draw_outline(ctx, second_hand);
-//     gpath_draw_outline(ctx, minute_hand);
-//     gpath_draw_outline(ctx, hour_hand);
+    const bool full = circlock_bg_frame_is_full();
+    CirclockHandsState state;
+    circlock_hands_get_state(&state);
+#if CIRCLOCK_RENDER_DIFF
+    if (!full && drawn_state_valid && circlock_render_hands_equal(&state, &drawn_state))
+    {
+        circlock_render_part_drawn(CIRCLOCK_RENDER_HANDS, false);
+        return;
+    }
+#endif
+    drawn_state = state;
+    drawn_state_valid = true;
+    circlock_render_part_drawn(CIRCLOCK_RENDER_HANDS, true);
+
+    // on patched frames the rest of the face is still in the frame buffer,
+    // only the rings under the previous second hands have to be put back
+    GRect restored[CIRCLOCK_RINGS];
+    uint8_t restored_count = 0;
+    uint8_t ring;
+    if (!full && second_hands_drawn)
+    {
+        for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+        {
+            if (ticks_seconds(ring))
+            {
+                restored[restored_count++] = circlock_bg_restore_rect(ctx, second_hand_rects[ring]);
+            }
+        }
+    }
+
+#if CIRCLOCK_HANDS_SECTORS
+    GBitmap *frame_buffer = circlock_sector_begin(layer, ctx);
+#else
+    GBitmap *frame_buffer = NULL;
+#endif
+    graphics_context_set_fill_color(ctx, circlock_geometry()->layout.background);
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        GPoint points[CIRCLOCK_HAND_POINTS];
+        hand_points(ring, points);
+        const GRect bounds = hand_bounds(points);
+        bool draw = full;
+        if (ticks_seconds(ring))
+        {
+            second_hand_rects[ring] = bounds;
+            draw = second_hands_visible;
+        }
+        else
+        {
+            uint8_t i;
+            for (i = 0; i < restored_count && !draw; ++i)
+            {
+                draw = rects_intersect(restored[i], bounds);
+            }
+        }
+        if (draw)
+        {
+            draw_hand(ctx, frame_buffer, ring, points);
+        }
+    }
+    circlock_sector_end(ctx, frame_buffer);
+    second_hands_drawn = second_hands_visible;
+}
+
+void circlock_hands_set_time(const struct tm *t)
+{
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        ring_steps[ring] = time_step(ring, t);
+    }
+    second = t->tm_sec % 60;
+    second_millis = 0;
+}
+
+#if CIRCLOCK_SWEEP
+
+void circlock_hands_set_second_position(uint8_t position, uint16_t millis)
+{
+    second = position % 60;
+    second_millis = millis;
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        if (ticks_seconds(ring))
+        {
+            ring_steps[ring] = second * circlock_rings[ring].steps / 60;
+        }
+    }
+}
+
+#endif
+
+#if CIRCLOCK_FEATURE_SECONDS
+
+void circlock_hands_set_second_visible(bool visible)
+{
+    second_hands_visible = visible;
+}
+
+#endif
+
+void circlock_hands_get_state(CirclockHandsState *state)
+{
+    memcpy(state->steps, ring_steps, sizeof(ring_steps));
+    state->second = second;
+    state->second_millis = second_millis;
+    state->second_visible = second_hands_visible;
 }
 
 void circlock_hands_init(Layer *layer)
 {
-    const GRect bounds = layer_get_bounds(layer);
-    GPoint center = grect_center_point(&bounds);
-    center.y = CIRCLOCK_CLOCK_CENTER_Y + CIRCLOCK_HAND_HEIGHT - CIRCLOCK_HAND_HEIGHT;
-    
-    second_hand = gpath_create(&SECOND_HAND_POINTS);
-    minute_hand = gpath_create(&MINUTE_HAND_POINTS);
-    hour_hand = gpath_create(&HOUR_HAND_POINTS);
-    
-    gpath_move_to(second_hand, center);
-    gpath_move_to(minute_hand, center);
-    gpath_move_to(hour_hand, center);
+    second_hands_drawn = false;
+    drawn_state_valid = false;
 }
 
 void circlock_hands_deinit()
 {
-    gpath_destroy(second_hand);
-    gpath_destroy(minute_hand);
-    gpath_destroy(hour_hand);
+    second_hands_drawn = false;
+    drawn_state_valid = false;
+    second_millis = 0;
 }
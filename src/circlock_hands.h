@@ -24,6 +24,23 @@
     
 #include <pebble.h>
 
+#include "circlock_conf.h"
+#include "circlock_render.h"
+
 extern void circlock_hands_update_proc(Layer *, GContext *);
+extern void circlock_hands_set_time(const struct tm *);
+extern void circlock_hands_get_state(CirclockHandsState *);
 extern void circlock_hands_init(Layer *);
 extern void circlock_hands_deinit();
+
+#if CIRCLOCK_SWEEP
+extern void circlock_hands_set_second_position(uint8_t second, uint16_t millis);
+#else
+#define circlock_hands_set_second_position(second, millis)
+#endif
+
+#if CIRCLOCK_FEATURE_SECONDS
+extern void circlock_hands_set_second_visible(bool);
+#else
+#define circlock_hands_set_second_visible(visible)
+#endif
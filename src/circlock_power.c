@@ -0,0 +1,163 @@
+// circlock_power.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_power.h"
+
+#include "circlock_conf.h"
+
+// The face ticks every second only for a while after it is launched or
+// glanced at, otherwise it wakes up once a minute and hides the second hand.
+// Builds without CIRCLOCK_FEATURE_SECONDS only ever tick once a minute.
+
+static CirclockPowerHandlers handlers;
+static bool seconds_active = false;
+#if CIRCLOCK_FEATURE_SECONDS
+static uint16_t seconds_left = 0;
+#endif
+
+static uint16_t wakeups = 0;
+static uint16_t seconds_ticks = 0;
+static int last_hour = -1;
+
+static void handle_tick(struct tm *tick_time, TimeUnits units_changed);
+
+#if CIRCLOCK_FEATURE_SECONDS
+
+static bool is_quiet_hour(int hour)
+{
+#if CIRCLOCK_POWER_QUIET_START_HOUR == CIRCLOCK_POWER_QUIET_END_HOUR
+    return false;
+#elif CIRCLOCK_POWER_QUIET_START_HOUR < CIRCLOCK_POWER_QUIET_END_HOUR
+    return hour >= CIRCLOCK_POWER_QUIET_START_HOUR && hour < CIRCLOCK_POWER_QUIET_END_HOUR;
+#else
+    return hour >= CIRCLOCK_POWER_QUIET_START_HOUR || hour < CIRCLOCK_POWER_QUIET_END_HOUR;
+#endif
+}
+
+static int current_hour()
+{
+    time_t now = time(NULL);
+    return localtime(&now)->tm_hour;
+}
+
+static void set_seconds_active(bool active)
+{
+    if (active == seconds_active)
+    {
+        return;
+    }
+    seconds_active = active;
+    tick_timer_service_subscribe(active ? SECOND_UNIT : MINUTE_UNIT, &handle_tick);
+    if (handlers.resolution_changed)
+    {
+        handlers.resolution_changed(active);
+    }
+}
+
+static void wake(uint16_t seconds)
+{
+    if (is_quiet_hour(current_hour()))
+    {
+        return;
+    }
+    seconds_left = seconds;
+    set_seconds_active(true);
+    if (handlers.glance)
+    {
+        handlers.glance();
+    }
+}
+
+#endif
+
+static void log_wakeups(int hour)
+{
+    if (last_hour >= 0 && hour != last_hour)
+    {
+        APP_LOG(APP_LOG_LEVEL_INFO, "power: %u wakeups in hour %d, %u at second resolution",
+                wakeups, last_hour, seconds_ticks);
+        wakeups = 0;
+        seconds_ticks = 0;
+    }
+    last_hour = hour;
+}
+
+static void handle_tick(struct tm *tick_time, TimeUnits units_changed)
+{
+    log_wakeups(tick_time->tm_hour);
+    ++wakeups;
+    if (seconds_active)
+    {
+        ++seconds_ticks;
+    }
+
+    if (handlers.tick)
+    {
+        handlers.tick(tick_time, units_changed);
+    }
+
+#if CIRCLOCK_FEATURE_SECONDS
+    if (seconds_active && (seconds_left == 0 || --seconds_left == 0 || is_quiet_hour(tick_time->tm_hour)))
+    {
+        set_seconds_active(false);
+    }
+#endif
+}
+
+#if CIRCLOCK_FEATURE_SECONDS
+static void handle_tap(AccelAxisType axis, int32_t direction)
+{
+    ++wakeups;
+    wake(CIRCLOCK_POWER_GLANCE_SECONDS);
+}
+#endif
+
+bool circlock_power_seconds_active()
+{
+    return seconds_active;
+}
+
+void circlock_power_init(CirclockPowerHandlers power_handlers)
+{
+    handlers = power_handlers;
+    seconds_active = false;
+    tick_timer_service_subscribe(MINUTE_UNIT, &handle_tick);
+#if CIRCLOCK_FEATURE_SECONDS
+    wake(CIRCLOCK_POWER_IDLE_SECONDS);
+#endif
+    if (!seconds_active && handlers.resolution_changed)
+    {
+        handlers.resolution_changed(false);
+    }
+#if CIRCLOCK_FEATURE_SECONDS
+    accel_tap_service_subscribe(&handle_tap);
+#endif
+}
+
+void circlock_power_deinit()
+{
+#if CIRCLOCK_FEATURE_SECONDS
+    accel_tap_service_unsubscribe();
+#endif
+    tick_timer_service_unsubscribe();
+    seconds_active = false;
+}
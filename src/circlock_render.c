@@ -0,0 +1,133 @@
+// circlock_render.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_render.h"
+
+#include "circlock_conf.h"
+
+static const char *PART_NAMES[CIRCLOCK_RENDER_PARTS] = { "hands", "battery", "labels" };
+
+// state of the last frame requested, a pending frame draws whatever is
+// current when it is rendered
+static CirclockRenderState requested;
+static bool requested_valid = false;
+static bool frame_pending = false;
+
+static CirclockRenderStats stats;
+
+bool circlock_render_hands_equal(const CirclockHandsState *a, const CirclockHandsState *b)
+{
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        if (a->steps[ring] != b->steps[ring])
+        {
+            return false;
+        }
+    }
+    return a->second == b->second && a->second_millis == b->second_millis
+        && a->second_visible == b->second_visible;
+}
+
+bool circlock_render_battery_equal(const CirclockBatteryState *a, const CirclockBatteryState *b)
+{
+    return a->segments == b->segments && a->blink == b->blink;
+}
+
+static bool labels_equal(const CirclockLabelsState *a, const CirclockLabelsState *b)
+{
+    return strcmp(a->time, b->time) == 0 && strcmp(a->date, b->date) == 0;
+}
+
+bool circlock_render_state_equal(const CirclockRenderState *a, const CirclockRenderState *b)
+{
+    return a->foreground == b->foreground && a->background == b->background
+        && circlock_render_hands_equal(&a->hands, &b->hands)
+        && circlock_render_battery_equal(&a->battery, &b->battery)
+        && labels_equal(&a->labels, &b->labels);
+}
+
+bool circlock_render_request(const CirclockRenderState *state, bool full)
+{
+#if CIRCLOCK_RENDER_DIFF
+    if (!full && !frame_pending && requested_valid && circlock_render_state_equal(state, &requested))
+    {
+        ++stats.frames_skipped;
+        return false;
+    }
+#endif
+    requested = *state;
+    requested_valid = true;
+    frame_pending = true;
+    return true;
+}
+
+void circlock_render_frame_drawn(bool full)
+{
+    frame_pending = false;
+    ++stats.frames_drawn;
+    // patch frames hide the labels
+    circlock_render_part_drawn(CIRCLOCK_RENDER_LABELS, full);
+}
+
+void circlock_render_part_drawn(CirclockRenderPart part, bool drawn)
+{
+    if (drawn)
+    {
+        ++stats.parts_drawn[part];
+    }
+    else
+    {
+        ++stats.parts_skipped[part];
+    }
+}
+
+const CirclockRenderStats *circlock_render_stats()
+{
+    return &stats;
+}
+
+void circlock_render_log()
+{
+    APP_LOG(APP_LOG_LEVEL_INFO, "render: %u frames drawn, %u skipped",
+            (unsigned)stats.frames_drawn, (unsigned)stats.frames_skipped);
+    uint8_t i;
+    for (i = 0; i < CIRCLOCK_RENDER_PARTS; ++i)
+    {
+        APP_LOG(APP_LOG_LEVEL_INFO, "render: %s drawn in %u frames, skipped in %u",
+                PART_NAMES[i], (unsigned)stats.parts_drawn[i], (unsigned)stats.parts_skipped[i]);
+    }
+}
+
+void circlock_render_init()
+{
+    memset(&stats, 0, sizeof(stats));
+    requested_valid = false;
+    frame_pending = false;
+}
+
+void circlock_render_deinit()
+{
+    circlock_render_log();
+    requested_valid = false;
+    frame_pending = false;
+}
@@ -0,0 +1,85 @@
+// circlock_render.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_geometry.h"
+
+// Everything a frame of the face shows, reduced to the values it is drawn
+// from. A frame whose state equals the last one requested would put the
+// same pixels into the retained frame buffer and is skipped.
+typedef struct {
+    uint8_t steps[CIRCLOCK_RINGS];
+    uint8_t second;
+    uint16_t second_millis;
+    bool second_visible;
+} CirclockHandsState;
+
+typedef struct {
+    uint8_t segments;
+    int8_t blink;
+} CirclockBatteryState;
+
+typedef struct {
+    char time[8];
+    char date[15];
+} CirclockLabelsState;
+
+typedef struct {
+    GColor foreground;
+    GColor background;
+    CirclockHandsState hands;
+    CirclockBatteryState battery;
+    CirclockLabelsState labels;
+} CirclockRenderState;
+
+typedef enum {
+    CIRCLOCK_RENDER_HANDS = 0,
+    CIRCLOCK_RENDER_BATTERY,
+    CIRCLOCK_RENDER_LABELS,
+    CIRCLOCK_RENDER_PARTS,
+} CirclockRenderPart;
+
+typedef struct {
+    uint32_t frames_drawn;
+    uint32_t frames_skipped;
+    uint32_t parts_drawn[CIRCLOCK_RENDER_PARTS];
+    uint32_t parts_skipped[CIRCLOCK_RENDER_PARTS];
+} CirclockRenderStats;
+
+extern bool circlock_render_hands_equal(const CirclockHandsState *, const CirclockHandsState *);
+extern bool circlock_render_battery_equal(const CirclockBatteryState *, const CirclockBatteryState *);
+extern bool circlock_render_state_equal(const CirclockRenderState *, const CirclockRenderState *);
+
+// Returns whether a frame showing state has to be drawn, a full frame is
+// always drawn. Patch frames that would not change the frame buffer are
+// counted as skipped.
+extern bool circlock_render_request(const CirclockRenderState *, bool full);
+extern void circlock_render_frame_drawn(bool full);
+extern void circlock_render_part_drawn(CirclockRenderPart, bool drawn);
+
+extern const CirclockRenderStats *circlock_render_stats();
+extern void circlock_render_log();
+extern void circlock_render_init();
+extern void circlock_render_deinit();
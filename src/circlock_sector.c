@@ -0,0 +1,186 @@
+// circlock_sector.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_sector.h"
+
+#include "circlock_conf.h"
+
+// A hand is the part of its ring between the two rays through the corners
+// of the hand at the middle of the ring. Rows are filled straight into the
+// 1-bit frame buffer: the ring table gives the span of the annulus and the
+// rays clip it, all in integers scaled by TRIG_MAX_RATIO.
+
+static int32_t div_floor(int32_t a, int32_t b)
+{
+    const int32_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static int32_t div_ceil(int32_t a, int32_t b)
+{
+    return -div_floor(-a, b);
+}
+
+static void fill_span(uint8_t *row, int16_t x0, int16_t x1, bool set)
+{
+    const int16_t first = x0 / 8;
+    const int16_t last = x1 / 8;
+    uint8_t first_mask = 0xff << (x0 % 8);
+    const uint8_t last_mask = 0xff >> (7 - x1 % 8);
+    if (first == last)
+    {
+        first_mask &= last_mask;
+    }
+    row[first] = set ? row[first] | first_mask : row[first] & ~first_mask;
+    if (first == last)
+    {
+        return;
+    }
+    if (last - first > 1)
+    {
+        memset(row + first + 1, set ? 0xff : 0x00, last - first - 1);
+    }
+    row[last] = set ? row[last] | last_mask : row[last] & ~last_mask;
+}
+
+// clips [x0, x1] from the center to the frame buffer and fills it
+static void fill_row(uint8_t *row, int16_t width, int16_t center_x, int32_t x0, int32_t x1, bool set)
+{
+    x0 += center_x;
+    x1 += center_x;
+    x0 = x0 < 0 ? 0 : x0;
+    x1 = x1 >= width ? width - 1 : x1;
+    if (x0 <= x1)
+    {
+        fill_span(row, x0, x1, set);
+    }
+}
+
+// the captured frame buffer when the layer covers all of it, NULL when the
+// hands have to be drawn as paths
+GBitmap *circlock_sector_begin(Layer *layer, GContext *ctx)
+{
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        return NULL;
+    }
+    const GRect fb_bounds = gbitmap_get_bounds(frame_buffer);
+    const GRect frame = layer_get_frame(layer);
+    if (gbitmap_get_format(frame_buffer) != GBitmapFormat1Bit
+        || frame.origin.x != fb_bounds.origin.x || frame.origin.y != fb_bounds.origin.y
+        || frame.size.w != fb_bounds.size.w || frame.size.h != fb_bounds.size.h)
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return NULL;
+    }
+    return frame_buffer;
+}
+
+void circlock_sector_fill(GBitmap *frame_buffer, GPoint center, uint8_t ring, int32_t angle, GRect rows, GColor color)
+{
+    const int32_t sine = sin_lookup(angle);
+    const int32_t cosine = cos_lookup(angle);
+    const CirclockGeometry *geometry = circlock_geometry();
+    const uint8_t *radii = geometry->layout.ring_radii[ring];
+    const int8_t (*extents)[2] = geometry->ring_extents + ring * geometry->layout.ring_rows;
+    const int32_t half = geometry->config.hand_width / 2;
+    const int32_t mid = (radii[0] + radii[1]) / 2;
+
+    // the bounding rays, rotated like the hand tables rotate (x, y)
+    const int32_t left_x = -half * cosine - mid * sine;
+    const int32_t left_y = mid * cosine - half * sine;
+    const int32_t right_x = half * cosine - mid * sine;
+    const int32_t right_y = mid * cosine + half * sine;
+
+    const GRect bounds = gbitmap_get_bounds(frame_buffer);
+    const uint16_t row_bytes = gbitmap_get_bytes_per_row(frame_buffer);
+    uint8_t *data = gbitmap_get_data(frame_buffer);
+    const bool set = color == GColorWhite;
+    const int16_t y0 = rows.origin.y < 0 ? 0 : rows.origin.y;
+    const int16_t y1 = rows.origin.y + rows.size.h > bounds.size.h ? bounds.size.h : rows.origin.y + rows.size.h;
+    int16_t y;
+    for (y = y0; y < y1; ++y)
+    {
+        const int32_t dy = y - center.y;
+        const int32_t row = dy < 0 ? -dy : dy;
+        if (row >= geometry->layout.ring_rows || extents[row][1] < 0)
+        {
+            continue;
+        }
+        const int32_t hole = extents[row][0];
+        int32_t x0 = -extents[row][1];
+        int32_t x1 = extents[row][1];
+
+        // right of the left ray: left_x * dy - left_y * x <= 0
+        const int32_t left = left_x * dy;
+        if (left_y > 0)
+        {
+            const int32_t x = div_ceil(left, left_y);
+            x0 = x > x0 ? x : x0;
+        }
+        else if (left_y < 0)
+        {
+            const int32_t x = div_floor(left, left_y);
+            x1 = x < x1 ? x : x1;
+        }
+        else if (left > 0)
+        {
+            continue;
+        }
+        // left of the right ray: right_x * dy - right_y * x >= 0
+        const int32_t right = right_x * dy;
+        if (right_y > 0)
+        {
+            const int32_t x = div_floor(right, right_y);
+            x1 = x < x1 ? x : x1;
+        }
+        else if (right_y < 0)
+        {
+            const int32_t x = div_ceil(right, right_y);
+            x0 = x > x0 ? x : x0;
+        }
+        else if (right < 0)
+        {
+            continue;
+        }
+
+        uint8_t *line = data + y * row_bytes;
+        if (hole < 0)
+        {
+            fill_row(line, bounds.size.w, center.x, x0, x1, set);
+        }
+        else
+        {
+            fill_row(line, bounds.size.w, center.x, x0, x1 < -hole - 1 ? x1 : -hole - 1, set);
+            fill_row(line, bounds.size.w, center.x, x0 > hole + 1 ? x0 : hole + 1, x1, set);
+        }
+    }
+}
+
+void circlock_sector_end(GContext *ctx, GBitmap *frame_buffer)
+{
+    if (frame_buffer)
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+    }
+}
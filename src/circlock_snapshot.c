@@ -0,0 +1,396 @@
+// circlock_snapshot.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_snapshot.h"
+
+#if CIRCLOCK_SNAPSHOT
+
+#include "circlock_bg.h"
+#include "circlock_geometry.h"
+#include "circlock_util.h"
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_KEY 0x300
+#define SNAPSHOT_DATA_KEY 0x301
+#define SNAPSHOT_MAX_ROW_BYTES 32
+
+// Coding: every row is XORed with the row above, which leaves little but
+// the edges of the rings and of the labels. The runs of clear pixels before
+// every set one, in row-major order, are Elias gamma coded as run + 1 from
+// the most significant bit of every byte on. A run that reaches past the
+// last pixel ends the frame.
+typedef struct {
+    uint8_t version;
+    uint16_t size;
+    int16_t width;
+    int16_t height;
+    uint32_t time;
+} SnapshotHeader;
+
+typedef struct {
+    uint8_t *data;
+    uint16_t capacity;
+    uint32_t bit;
+    bool overflow;
+} BitWriter;
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t bits;
+    uint32_t bit;
+} BitReader;
+
+// the coded frame, of this session once one has been captured and of the
+// last session until then
+static uint8_t coded[CIRCLOCK_SNAPSHOT_MAX_BYTES];
+static SnapshotHeader header;
+static bool loaded = false;
+static bool captured = false;
+
+static uint32_t launch_ms = 0;
+static bool face_logged = false;
+
+static uint16_t chunk_size(uint16_t offset)
+{
+    return header.size - offset < PERSIST_DATA_MAX_LENGTH ? header.size - offset : PERSIST_DATA_MAX_LENGTH;
+}
+
+static void write_gamma(BitWriter *writer, uint32_t value)
+{
+    uint8_t length = 0;
+    while (value >> (length + 1))
+    {
+        ++length;
+    }
+    if (writer->bit + 2 * length + 1 > (uint32_t)writer->capacity * 8)
+    {
+        writer->overflow = true;
+        return;
+    }
+    writer->bit += length;
+    int8_t i;
+    for (i = length; i >= 0; --i, ++writer->bit)
+    {
+        const uint8_t mask = 0x80 >> (writer->bit % 8);
+        if (value >> i & 1)
+        {
+            writer->data[writer->bit / 8] |= mask;
+        }
+    }
+}
+
+// UINT32_MAX once the stream is used up
+static uint32_t read_gamma(BitReader *reader)
+{
+    uint8_t length = 0;
+    while (reader->bit < reader->bits && !(reader->data[reader->bit / 8] & (0x80 >> (reader->bit % 8))))
+    {
+        ++length;
+        ++reader->bit;
+    }
+    if (length > 31 || reader->bit + length + 1 > reader->bits)
+    {
+        return UINT32_MAX;
+    }
+    uint32_t value = 0;
+    uint8_t i;
+    for (i = 0; i <= length; ++i, ++reader->bit)
+    {
+        value = value << 1 | ((reader->data[reader->bit / 8] >> (7 - reader->bit % 8)) & 1);
+    }
+    return value;
+}
+
+// the snapshot only works on a 1-bit frame buffer the layer covers
+static bool covers(GBitmap *frame_buffer, Layer *layer)
+{
+    const GRect fb_bounds = gbitmap_get_bounds(frame_buffer);
+    const GRect frame = layer_get_frame(layer);
+    return gbitmap_get_format(frame_buffer) == GBitmapFormat1Bit
+        && (fb_bounds.size.w + 7) / 8 <= SNAPSHOT_MAX_ROW_BYTES
+        && frame.origin.x == fb_bounds.origin.x && frame.origin.y == fb_bounds.origin.y
+        && frame.size.w == fb_bounds.size.w && frame.size.h == fb_bounds.size.h;
+}
+
+static void copy_span(uint8_t *row, const uint8_t *source, int16_t width, int16_t x0, int16_t x1)
+{
+    x0 = x0 < 0 ? 0 : x0;
+    x1 = x1 >= width ? width - 1 : x1;
+    int16_t x;
+    for (x = x0; x <= x1; ++x)
+    {
+        const uint8_t mask = 1 << (x % 8);
+        row[x / 8] = (row[x / 8] & ~mask) | (source[x / 8] & mask);
+    }
+}
+
+// The second hands will have moved by the time the snapshot is shown, their
+// rings are taken from the background instead. The spans of neighbouring
+// rings share a pixel in places, the other rings keep those.
+static void exclude_second_rings(uint8_t *row, int16_t y, int16_t width)
+{
+    const uint8_t *background = circlock_bg_cache_row(y);
+    if (!background)
+    {
+        return;
+    }
+    const CirclockGeometry *geometry = circlock_geometry();
+    const GPoint center = geometry->layout.center;
+    const int16_t dy = y < center.y ? center.y - y : y - center.y;
+    const uint8_t rows = geometry->layout.ring_rows;
+    if (dy >= rows)
+    {
+        return;
+    }
+    uint8_t ring;
+    for (ring = 0; ring < CIRCLOCK_RINGS; ++ring)
+    {
+        if (circlock_rings[ring].unit != CIRCLOCK_UNIT_SECOND)
+        {
+            continue;
+        }
+        const int8_t *extent = geometry->ring_extents[ring * rows + dy];
+        int16_t inside = extent[0];
+        int16_t outside = extent[1];
+        if (ring + 1 < CIRCLOCK_RINGS)
+        {
+            const int8_t *inner = geometry->ring_extents[(ring + 1) * rows + dy];
+            inside = inner[1] > inside ? inner[1] : inside;
+        }
+        if (ring > 0)
+        {
+            const int8_t *outer = geometry->ring_extents[(ring - 1) * rows + dy];
+            outside = outer[0] < outside ? outer[0] : outside;
+        }
+        if (outside < 0 || outside <= inside)
+        {
+            continue;
+        }
+        if (inside < 0)
+        {
+            copy_span(row, background, width, center.x - outside, center.x + outside);
+            continue;
+        }
+        copy_span(row, background, width, center.x - outside, center.x - inside - 1);
+        copy_span(row, background, width, center.x + inside + 1, center.x + outside);
+    }
+}
+
+bool circlock_snapshot_load()
+{
+    loaded = false;
+    if (persist_read_data(SNAPSHOT_HEADER_KEY, &header, sizeof(header)) != sizeof(header)
+        || header.version != SNAPSHOT_VERSION || header.size == 0 || header.size > sizeof(coded))
+    {
+        return false;
+    }
+    // the hands and labels of an old snapshot would be too far off
+    const uint32_t now = time(NULL);
+    if (now < header.time || now - header.time > CIRCLOCK_SNAPSHOT_MAX_AGE_SECONDS)
+    {
+        return false;
+    }
+    uint16_t offset;
+    for (offset = 0; offset < header.size; offset += PERSIST_DATA_MAX_LENGTH)
+    {
+        const uint16_t size = chunk_size(offset);
+        if (persist_read_data(SNAPSHOT_DATA_KEY + offset / PERSIST_DATA_MAX_LENGTH, coded + offset, size) != size)
+        {
+            return false;
+        }
+    }
+    loaded = true;
+    return true;
+}
+
+bool circlock_snapshot_draw(Layer *layer, GContext *ctx)
+{
+    if (!loaded)
+    {
+        return false;
+    }
+    loaded = false;
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        return false;
+    }
+    const GRect bounds = gbitmap_get_bounds(frame_buffer);
+    if (!covers(frame_buffer, layer) || bounds.size.w != header.width || bounds.size.h != header.height)
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return false;
+    }
+
+    const uint16_t row_bytes = gbitmap_get_bytes_per_row(frame_buffer);
+    const uint16_t width_bytes = (bounds.size.w + 7) / 8;
+    const uint32_t pixels = (uint32_t)bounds.size.w * bounds.size.h;
+    uint8_t *data = gbitmap_get_data(frame_buffer);
+    int16_t y;
+    for (y = 0; y < bounds.size.h; ++y)
+    {
+        memset(data + y * row_bytes, 0, width_bytes);
+    }
+    BitReader reader = { coded, (uint32_t)header.size * 8, 0 };
+    uint32_t pixel = UINT32_MAX;
+    for (;;)
+    {
+        const uint32_t run = read_gamma(&reader);
+        if (run == UINT32_MAX || run > pixels - (pixel + 1))
+        {
+            break;
+        }
+        pixel += run;
+        const uint16_t x = pixel % bounds.size.w;
+        data[pixel / bounds.size.w * row_bytes + x / 8] |= 1 << (x % 8);
+    }
+    for (y = 1; y < bounds.size.h; ++y)
+    {
+        uint8_t *row = data + y * row_bytes;
+        uint16_t x;
+        for (x = 0; x < width_bytes; ++x)
+        {
+            row[x] ^= row[x - row_bytes];
+        }
+    }
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    APP_LOG(APP_LOG_LEVEL_INFO, "snapshot: shown %u ms after launch, %u bytes",
+            (unsigned)(circlock_util_now_ms() - launch_ms), header.size);
+    return true;
+}
+
+bool circlock_snapshot_due()
+{
+    return !captured || (uint32_t)time(NULL) - header.time >= CIRCLOCK_SNAPSHOT_INTERVAL_SECONDS;
+}
+
+void circlock_snapshot_capture(Layer *layer, GContext *ctx)
+{
+    if (!face_logged)
+    {
+        face_logged = true;
+        APP_LOG(APP_LOG_LEVEL_INFO, "snapshot: face drawn %u ms after launch", (unsigned)(circlock_util_now_ms() - launch_ms));
+    }
+    GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer)
+    {
+        return;
+    }
+    if (!covers(frame_buffer, layer))
+    {
+        graphics_release_frame_buffer(ctx, frame_buffer);
+        return;
+    }
+
+    const GRect bounds = gbitmap_get_bounds(frame_buffer);
+    const uint16_t row_bytes = gbitmap_get_bytes_per_row(frame_buffer);
+    const uint16_t width_bytes = (bounds.size.w + 7) / 8;
+    const uint8_t *data = gbitmap_get_data(frame_buffer);
+    uint8_t above[SNAPSHOT_MAX_ROW_BYTES] = { 0 };
+    uint8_t row[SNAPSHOT_MAX_ROW_BYTES];
+    memset(coded, 0, sizeof(coded));
+    BitWriter writer = { coded, sizeof(coded), 0, false };
+    uint32_t last = UINT32_MAX;
+    int16_t y;
+    for (y = 0; y < bounds.size.h; ++y)
+    {
+        memcpy(row, data + y * row_bytes, width_bytes);
+        if (bounds.size.w % 8)
+        {
+            row[width_bytes - 1] &= (1 << (bounds.size.w % 8)) - 1;
+        }
+        exclude_second_rings(row, y, bounds.size.w);
+        uint16_t x;
+        for (x = 0; x < width_bytes; ++x)
+        {
+            uint8_t changed = row[x] ^ above[x];
+            while (changed)
+            {
+                const uint8_t bit = __builtin_ctz(changed);
+                changed &= changed - 1;
+                const uint32_t pixel = (uint32_t)y * bounds.size.w + x * 8 + bit;
+                write_gamma(&writer, pixel - last);
+                last = pixel;
+            }
+        }
+        memcpy(above, row, width_bytes);
+    }
+    write_gamma(&writer, (uint32_t)bounds.size.w * bounds.size.h - last);
+    graphics_release_frame_buffer(ctx, frame_buffer);
+
+    loaded = false;
+    captured = true;
+    header = (SnapshotHeader){
+        .version = SNAPSHOT_VERSION,
+        .size = writer.overflow ? 0 : (writer.bit + 7) / 8,
+        .width = bounds.size.w,
+        .height = bounds.size.h,
+        .time = time(NULL),
+    };
+}
+
+void circlock_snapshot_invalidate()
+{
+    header.time = 0;
+}
+
+void circlock_snapshot_init()
+{
+    launch_ms = circlock_util_now_ms();
+    face_logged = false;
+    loaded = false;
+    captured = false;
+}
+
+void circlock_snapshot_deinit()
+{
+    if (!captured)
+    {
+        return;
+    }
+    captured = false;
+    // a frame that did not fit leaves no snapshot rather than an old one
+    if (header.size == 0)
+    {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "snapshot: frame over %u bytes", (unsigned)sizeof(coded));
+        persist_delete(SNAPSHOT_HEADER_KEY);
+        return;
+    }
+    // no header describes the chunks while they are rewritten
+    persist_delete(SNAPSHOT_HEADER_KEY);
+    uint16_t offset;
+    for (offset = 0; offset < header.size; offset += PERSIST_DATA_MAX_LENGTH)
+    {
+        const uint16_t size = chunk_size(offset);
+        const int written = persist_write_data(SNAPSHOT_DATA_KEY + offset / PERSIST_DATA_MAX_LENGTH, coded + offset, size);
+        if (written != size)
+        {
+            APP_LOG(APP_LOG_LEVEL_WARNING, "snapshot: cannot persist chunk %u (%d)",
+                    offset / PERSIST_DATA_MAX_LENGTH, written);
+            return;
+        }
+    }
+    persist_write_data(SNAPSHOT_HEADER_KEY, &header, sizeof(header));
+    APP_LOG(APP_LOG_LEVEL_INFO, "snapshot: %u bytes persisted", header.size);
+}
+
+#endif
@@ -0,0 +1,61 @@
+// circlock_snapshot.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+
+// The last full frame of a session, with the second ring as the background
+// has it, run-length coded once every CIRCLOCK_SNAPSHOT_INTERVAL_SECONDS and
+// written to persistent storage at exit. The next launch
+// shows it as its first frame while the face starts up behind it.
+
+#if CIRCLOCK_SNAPSHOT
+
+// reads the snapshot of the last session, false when there is none recent
+// enough to be shown
+extern bool circlock_snapshot_load();
+// decodes the loaded snapshot into the frame buffer, once
+extern bool circlock_snapshot_draw(Layer *, GContext *);
+// whether the last capture is CIRCLOCK_SNAPSHOT_INTERVAL_SECONDS old, or
+// there is none yet
+extern bool circlock_snapshot_due();
+// keeps the full frame just drawn for the next launch
+extern void circlock_snapshot_capture(Layer *, GContext *);
+// makes the next full frame due, after the layout changed
+extern void circlock_snapshot_invalidate();
+extern void circlock_snapshot_init();
+extern void circlock_snapshot_deinit();
+
+#else
+
+#define circlock_snapshot_load() false
+#define circlock_snapshot_draw(layer, ctx) false
+#define circlock_snapshot_due() false
+#define circlock_snapshot_capture(layer, ctx)
+#define circlock_snapshot_invalidate()
+#define circlock_snapshot_init()
+#define circlock_snapshot_deinit()
+
+#endif
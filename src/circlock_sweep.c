@@ -0,0 +1,163 @@
+// circlock_sweep.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_sweep.h"
+
+#if CIRCLOCK_SWEEP
+
+#include "circlock_trace.h"
+#include "circlock_util.h"
+
+// While a glance lasts the second hand sweeps in sub-second steps from an
+// AppTimer, the 1 Hz tick still draws the whole seconds. The governor halves
+// the frame rate whenever frames keep going over their share of the frame
+// period and falls back to plain ticking below CIRCLOCK_SWEEP_MIN_FPS.
+
+static CirclockSweepFrameHandler frame_handler = NULL;
+static AppTimer *sweep_timer = NULL;
+static bool running = false;
+static time_t sweep_end = 0;
+
+// frame rate picked by the governor, kept for the next glance
+static uint8_t fps = CIRCLOCK_SWEEP_FPS;
+static uint8_t over_budget_frames = 0;
+static uint16_t worst_frame_ms = 0;
+
+static uint16_t frame_period()
+{
+    return 1000 / fps;
+}
+
+// the timer frames land on multiples of the frame period, the frame on the
+// second boundary is left to the tick
+static uint32_t next_frame_delay(uint16_t millis)
+{
+    const uint16_t period = frame_period();
+    uint32_t next = (millis / period + 1) * period;
+    if (next + period / 2 > 1000)
+    {
+        next = 1000 + period;
+    }
+    return next - millis;
+}
+
+static void handle_sweep_timer(void *data)
+{
+    sweep_timer = NULL;
+    time_t seconds;
+    uint16_t millis;
+    time_ms(&seconds, &millis);
+    if (seconds >= sweep_end)
+    {
+        circlock_sweep_stop();
+        return;
+    }
+    CIRCLOCK_TRACE_TRIGGER(CIRCLOCK_TRACE_TRIGGER_SWEEP);
+    sweep_timer = app_timer_register(next_frame_delay(millis), handle_sweep_timer, NULL);
+    if (frame_handler)
+    {
+        frame_handler(seconds % 60, millis);
+    }
+}
+
+bool circlock_sweep_running()
+{
+    return running;
+}
+
+void circlock_sweep_frame_drawn(uint32_t start)
+{
+    if (!circlock_sweep_running())
+    {
+        return;
+    }
+    const uint32_t duration = circlock_util_now_ms() - start;
+    worst_frame_ms = duration > worst_frame_ms ? duration : worst_frame_ms;
+    if (duration * 100 <= (uint32_t)frame_period() * CIRCLOCK_SWEEP_BUDGET_PERCENT)
+    {
+        over_budget_frames = 0;
+        return;
+    }
+    if (++over_budget_frames < CIRCLOCK_SWEEP_OVER_BUDGET_FRAMES)
+    {
+        return;
+    }
+    over_budget_frames = 0;
+    fps /= 2;
+    APP_LOG(APP_LOG_LEVEL_INFO, "sweep: %u ms frame over budget, %u fps", (unsigned)duration, fps);
+    if (fps < CIRCLOCK_SWEEP_MIN_FPS)
+    {
+        circlock_sweep_stop();
+    }
+}
+
+void circlock_sweep_start()
+{
+    const BatteryChargeState charge_state = battery_state_service_peek();
+    if (!charge_state.is_charging && charge_state.charge_percent < CIRCLOCK_SWEEP_MIN_BATTERY_PERCENT)
+    {
+        circlock_sweep_stop();
+        return;
+    }
+    // a rate the governor gave up on is retried at the lowest one
+    fps = fps < CIRCLOCK_SWEEP_MIN_FPS ? CIRCLOCK_SWEEP_MIN_FPS : fps;
+    over_budget_frames = 0;
+
+    time_t seconds;
+    uint16_t millis;
+    time_ms(&seconds, &millis);
+    sweep_end = seconds + CIRCLOCK_SWEEP_SECONDS;
+    if (!running)
+    {
+        running = true;
+        worst_frame_ms = 0;
+        sweep_timer = app_timer_register(next_frame_delay(millis), handle_sweep_timer, NULL);
+    }
+}
+
+void circlock_sweep_stop()
+{
+    if (sweep_timer)
+    {
+        app_timer_cancel(sweep_timer);
+        sweep_timer = NULL;
+    }
+    if (running)
+    {
+        running = false;
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "sweep: stopped at %u fps, worst frame %u ms", fps, worst_frame_ms);
+    }
+}
+
+void circlock_sweep_init(CirclockSweepFrameHandler handler)
+{
+    frame_handler = handler;
+    fps = CIRCLOCK_SWEEP_FPS;
+}
+
+void circlock_sweep_deinit()
+{
+    circlock_sweep_stop();
+    frame_handler = NULL;
+}
+
+#endif
@@ -0,0 +1,50 @@
+// circlock_sweep.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+
+// called for every sweep frame with the second hand position to draw
+typedef void (*CirclockSweepFrameHandler)(uint8_t second, uint16_t millis);
+
+#if CIRCLOCK_SWEEP
+
+extern bool circlock_sweep_running();
+extern void circlock_sweep_frame_drawn(uint32_t start);
+extern void circlock_sweep_start();
+extern void circlock_sweep_stop();
+extern void circlock_sweep_init(CirclockSweepFrameHandler);
+extern void circlock_sweep_deinit();
+
+#else
+
+#define circlock_sweep_running() false
+#define circlock_sweep_frame_drawn(start)
+#define circlock_sweep_start()
+#define circlock_sweep_stop()
+#define circlock_sweep_init(handler)
+#define circlock_sweep_deinit()
+
+#endif
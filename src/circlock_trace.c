@@ -0,0 +1,127 @@
+// circlock_trace.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_trace.h"
+
+#if CIRCLOCK_TRACE
+
+#define TRACE_DATA_LOGGING_TAG 0xc1c10c01
+
+// ring of the latest samples, the oldest one is overwritten when it is full
+static CirclockTraceSample samples[CIRCLOCK_TRACE_SAMPLES];
+static uint16_t sample_head = 0;
+static uint16_t sample_count = 0;
+static CirclockTraceTrigger trigger = CIRCLOCK_TRACE_TRIGGER_NONE;
+
+#if CIRCLOCK_TRACE_DATA_LOGGING
+static DataLoggingSessionRef session = NULL;
+#endif
+
+void circlock_trace_set_trigger(CirclockTraceTrigger frame_trigger)
+{
+    trigger = frame_trigger;
+}
+
+void circlock_trace_record(CirclockTraceLayer layer, uint32_t start)
+{
+    const uint32_t duration = circlock_util_now_ms() - start;
+    samples[(sample_head + sample_count) % CIRCLOCK_TRACE_SAMPLES] = (CirclockTraceSample){
+        .layer = layer,
+        .trigger = trigger,
+        .duration_ms = duration > UINT16_MAX ? UINT16_MAX : duration,
+        .start_ms = start
+    };
+    if (sample_count < CIRCLOCK_TRACE_SAMPLES)
+    {
+        ++sample_count;
+    }
+    else
+    {
+        sample_head = (sample_head + 1) % CIRCLOCK_TRACE_SAMPLES;
+    }
+#if CIRCLOCK_TRACE_DUMP_WHEN_FULL
+    if (sample_count == CIRCLOCK_TRACE_SAMPLES)
+    {
+        circlock_trace_dump();
+    }
+#endif
+}
+
+_Static_assert(CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES % sizeof(CirclockTraceSample) == 0,
+               "trace samples must not be split over log lines");
+
+// the ring is dumped oldest sample first, in runs that are contiguous in
+// memory
+static void dump_run(const CirclockTraceSample *run, uint16_t run_count)
+{
+#if CIRCLOCK_TRACE_DATA_LOGGING
+    if (session)
+    {
+        data_logging_log(session, run, run_count);
+    }
+#else
+    circlock_util_log_hex("trace:", run, run_count * sizeof(CirclockTraceSample));
+#endif
+}
+
+void circlock_trace_dump()
+{
+#if !CIRCLOCK_TRACE_DATA_LOGGING
+    if (sample_count > 0)
+    {
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "trace dump: %u samples, durations in whole ms of time_ms()",
+                (unsigned)sample_count);
+    }
+#endif
+    const uint16_t first = CIRCLOCK_TRACE_SAMPLES - sample_head < sample_count ? CIRCLOCK_TRACE_SAMPLES - sample_head : sample_count;
+    if (first > 0)
+    {
+        dump_run(&samples[sample_head], first);
+    }
+    if (sample_count > first)
+    {
+        dump_run(samples, sample_count - first);
+    }
+    sample_head = 0;
+    sample_count = 0;
+}
+
+void circlock_trace_init()
+{
+    sample_head = 0;
+    sample_count = 0;
+    trigger = CIRCLOCK_TRACE_TRIGGER_LOAD;
+#if CIRCLOCK_TRACE_DATA_LOGGING
+    session = data_logging_create(TRACE_DATA_LOGGING_TAG, DATA_LOGGING_BYTE_ARRAY, sizeof(CirclockTraceSample), true);
+#endif
+}
+
+void circlock_trace_deinit()
+{
+    circlock_trace_dump();
+#if CIRCLOCK_TRACE_DATA_LOGGING
+    data_logging_finish(session);
+    session = NULL;
+#endif
+}
+
+#endif
@@ -0,0 +1,94 @@
+// circlock_trace.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+#include "circlock_util.h"
+
+typedef enum {
+    CIRCLOCK_TRACE_LAYER_BG = 0,
+    CIRCLOCK_TRACE_LAYER_HANDS,
+    CIRCLOCK_TRACE_LAYER_BATTERY,
+    CIRCLOCK_TRACE_LAYER_LABELS,
+    CIRCLOCK_TRACE_LAYER_SNAPSHOT,
+} CirclockTraceLayer;
+
+// what caused the frame a sample was drawn in
+typedef enum {
+    CIRCLOCK_TRACE_TRIGGER_NONE = 0,
+    CIRCLOCK_TRACE_TRIGGER_LOAD,
+    CIRCLOCK_TRACE_TRIGGER_SECOND_TICK,
+    CIRCLOCK_TRACE_TRIGGER_MINUTE_TICK,
+    CIRCLOCK_TRACE_TRIGGER_BATTERY,
+    CIRCLOCK_TRACE_TRIGGER_FOCUS,
+    CIRCLOCK_TRACE_TRIGGER_RESOLUTION,
+    CIRCLOCK_TRACE_TRIGGER_CHARGING,
+    CIRCLOCK_TRACE_TRIGGER_SWEEP,
+} CirclockTraceTrigger;
+
+// Dump format: little-endian samples of 8 bytes, logged as hex after a
+// "trace:" prefix or sent as DataLogging byte arrays. tools/trace_report.py
+// turns either into per-layer percentiles.
+//
+// Durations are differences of time_ms() readings, the finest clock an app
+// has, so they come in whole milliseconds: a proc that finishes within the
+// same millisecond records 0, and any sample may be off by one.
+typedef struct __attribute__((__packed__)) {
+    uint8_t layer;
+    uint8_t trigger;
+    uint16_t duration_ms;
+    uint32_t start_ms;
+} CirclockTraceSample;
+
+#if CIRCLOCK_TRACE
+
+// Wraps an update proc into traced_<proc>, install it with CIRCLOCK_TRACED().
+#define CIRCLOCK_TRACE_PROC(proc, layer_id) \
+    static void traced_##proc(Layer *layer, GContext *ctx) \
+    { \
+        const uint32_t start = circlock_util_now_ms(); \
+        proc(layer, ctx); \
+        circlock_trace_record(layer_id, start); \
+    }
+#define CIRCLOCK_TRACED(proc) traced_##proc
+#define CIRCLOCK_TRACE_TRIGGER(trigger) circlock_trace_set_trigger(trigger)
+
+extern void circlock_trace_record(CirclockTraceLayer, uint32_t start);
+extern void circlock_trace_set_trigger(CirclockTraceTrigger);
+extern void circlock_trace_dump();
+extern void circlock_trace_init();
+extern void circlock_trace_deinit();
+
+#else
+
+#define CIRCLOCK_TRACE_PROC(proc, layer_id)
+#define CIRCLOCK_TRACED(proc) proc
+#define CIRCLOCK_TRACE_TRIGGER(trigger)
+
+#define circlock_trace_dump()
+#define circlock_trace_init()
+#define circlock_trace_deinit()
+
+#endif
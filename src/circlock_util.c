@@ -0,0 +1,60 @@
+// circlock_util.c
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "circlock_util.h"
+
+#if CIRCLOCK_UTIL_NOW_MS
+
+uint32_t circlock_util_now_ms()
+{
+    time_t seconds;
+    uint16_t millis;
+    time_ms(&seconds, &millis);
+    return (uint32_t)seconds * 1000 + millis;
+}
+
+#endif
+
+#if CIRCLOCK_UTIL_LOG_HEX
+
+void circlock_util_log_hex(const char *prefix, const void *bytes, uint16_t length)
+{
+    static const char hex[] = "0123456789abcdef";
+    const uint8_t *data = bytes;
+    char line[2 * CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES + 1];
+    uint16_t i;
+    for (i = 0; i < length; i += CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES)
+    {
+        const uint16_t count = length - i < CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES ? length - i : CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES;
+        char *out = line;
+        uint16_t j;
+        for (j = 0; j < count; ++j)
+        {
+            *out++ = hex[data[i + j] >> 4];
+            *out++ = hex[data[i + j] & 0xf];
+        }
+        *out = '\0';
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "%s%s", prefix, line);
+    }
+}
+
+#endif
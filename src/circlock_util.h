@@ -0,0 +1,47 @@
+// circlock_util.h
+//
+// Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <pebble.h>
+
+#include "circlock_conf.h"
+
+// only built for the modules that use them
+#define CIRCLOCK_UTIL_NOW_MS (CIRCLOCK_TRACE || CIRCLOCK_SWEEP || CIRCLOCK_SNAPSHOT || CIRCLOCK_BG_PROFILE)
+#define CIRCLOCK_UTIL_LOG_HEX (CIRCLOCK_ENERGY || (CIRCLOCK_TRACE && !CIRCLOCK_TRACE_DATA_LOGGING))
+
+// bytes of data in every line of circlock_util_log_hex(), a multiple of the
+// size of the records logged so that none is split over two lines
+#define CIRCLOCK_UTIL_LOG_HEX_LINE_BYTES 48
+
+#if CIRCLOCK_UTIL_NOW_MS
+// milliseconds of time_ms(), wrapping after 49 days, differences of two
+// readings are durations in whole ms
+extern uint32_t circlock_util_now_ms();
+#endif
+
+#if CIRCLOCK_UTIL_LOG_HEX
+// logs bytes as lines of lowercase hex after a prefix such as "trace:",
+// which the tools/ reports look for
+extern void circlock_util_log_hex(const char *prefix, const void *bytes, uint16_t length);
+#endif
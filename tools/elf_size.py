@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+#
+# elf_size.py
+#
+# Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+"""Reports the code and RAM size of the build variants of circlock.
+
+Sums the allocated sections of every ELF by their flags: read-only
+sections are code and constants, writable ones are initialized data or,
+without file contents, bss. A Pebble app is loaded whole into the app's
+RAM, so its footprint there is all three together; the heap is what is
+left of the app's RAM after it.
+"""
+
+from __future__ import print_function
+
+import struct
+import sys
+
+USAGE = 'usage: elf_size.py [--output FILE] NAME=ELF...'
+
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+def section_sizes(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF':
+        raise ValueError('%s is not an ELF file' % path)
+    wide = bytearray(data[4:5])[0] == 2
+    order = '<' if bytearray(data[5:6])[0] == 1 else '>'
+    if wide:
+        shoff, = struct.unpack_from(order + 'Q', data, 0x28)
+        shentsize, shnum = struct.unpack_from(order + 'HH', data, 0x3a)
+        section = order + 'IIQQQQIIQQ'
+    else:
+        shoff, = struct.unpack_from(order + 'I', data, 0x20)
+        shentsize, shnum = struct.unpack_from(order + 'HH', data, 0x2e)
+        section = order + 'IIIIIIIIII'
+
+    code = data_size = bss = 0
+    for index in range(shnum):
+        fields = struct.unpack_from(section, data, shoff + index * shentsize)
+        kind, flags, size = fields[1], fields[2], fields[5]
+        if not flags & SHF_ALLOC:
+            continue
+        if not flags & SHF_WRITE:
+            code += size
+        elif kind == SHT_NOBITS:
+            bss += size
+        else:
+            data_size += size
+    return code, data_size, bss
+
+
+def report(variants):
+    lines = ['%-12s %10s %10s %10s %10s' % ('variant', 'code', 'data', 'bss', 'ram')]
+    for name, path in variants:
+        code, data_size, bss = section_sizes(path)
+        lines.append('%-12s %10d %10d %10d %10d' % (name, code, data_size, bss, code + data_size + bss))
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    args = argv[1:]
+    output = None
+    if len(args) > 1 and args[0] == '--output':
+        output = args[1]
+        args = args[2:]
+    variants = [arg.split('=', 1) for arg in args]
+    if not variants or any(len(variant) != 2 for variant in variants):
+        print(USAGE, file=sys.stderr)
+        return 2
+    text = report(variants)
+    sys.stdout.write(text)
+    if output:
+        with open(output, 'w') as f:
+            f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,157 @@
+#!/usr/bin/env python
+#
+# energy_report.py
+#
+# Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+"""Reports the battery drain of circlock per mode.
+
+Reads `pebble logs` output containing the "energy:" lines that
+circlock_energy.c writes at launch, takes the last dump in it, and prints
+every sample followed by the drain of every mode in %/h. The drain is fitted
+here rather than on the watch, which has no FPU: over the intervals that run
+on battery from one change of the charge to the next, the drop is the sum of
+a constant rate per mode times the time spent in it, solved by least squares.
+"""
+
+from __future__ import print_function
+
+import binascii
+import re
+import struct
+import sys
+
+USAGE = 'usage: energy_report.py [FILE...]'
+
+# matches CirclockEnergySample in src/circlock_energy.h
+SAMPLE = struct.Struct('<HbBHH')
+
+FLAG_CHARGING = 0x01
+FLAG_LAUNCH = 0x02
+FLAG_COMPACT = 0x04
+
+MODES = ['minutes', 'seconds', 'sweep']
+
+ENERGY_RE = re.compile(r'energy:([0-9a-f]+)')
+
+
+def last_dump(lines):
+    dumps = []
+    previous_matched = False
+    for line in lines:
+        match = ENERGY_RE.search(line)
+        if match:
+            if not previous_matched:
+                dumps.append(b'')
+            dumps[-1] += binascii.unhexlify(match.group(1))
+        previous_matched = bool(match)
+    if not dumps:
+        return []
+    data = dumps[-1]
+    return [SAMPLE.unpack_from(data, offset) for offset in range(0, len(data) - SAMPLE.size + 1, SAMPLE.size)]
+
+
+def mode_seconds(sample):
+    minutes, _, _, seconds, sweep = sample
+    return [max(0, minutes * 60 - seconds - sweep), seconds, sweep]
+
+
+def usable(previous, sample):
+    return (not sample[2] & (FLAG_CHARGING | FLAG_LAUNCH) and not previous[2] & FLAG_CHARGING
+            and previous[1] != 0 and sample[1] < 0)
+
+
+def solve(matrix):
+    n = len(matrix)
+    for k in range(n):
+        pivot = max(range(k, n), key=lambda r: abs(matrix[r][k]))
+        if matrix[pivot][k] == 0:
+            return None
+        matrix[k], matrix[pivot] = matrix[pivot], matrix[k]
+        for r in range(n):
+            if r != k:
+                factor = matrix[r][k] / matrix[k][k]
+                matrix[r] = [a - factor * b for a, b in zip(matrix[r], matrix[k])]
+    return [matrix[k][n] / matrix[k][k] for k in range(n)]
+
+
+def drain(samples):
+    observed = [0] * len(MODES)
+    normal = [[0.0] * (len(MODES) + 1) for _ in MODES]
+    for previous, sample in zip(samples, samples[1:]):
+        if not usable(previous, sample):
+            continue
+        t = mode_seconds(sample)
+        for row in range(len(MODES)):
+            observed[row] += t[row]
+            for column in range(len(MODES)):
+                normal[row][column] += t[row] * t[column]
+            normal[row][len(MODES)] += t[row] * -sample[1]
+    modes = [m for m in range(len(MODES)) if observed[m]]
+    matrix = [[normal[r][c] for c in modes] + [normal[r][len(MODES)]] for r in modes]
+    rates = solve(matrix) if modes else None
+    result = dict((m, None) for m in range(len(MODES)))
+    if rates:
+        for m, rate in zip(modes, rates):
+            result[m] = rate * 3600
+    return result, observed
+
+
+def flags(value):
+    names = [('charging', FLAG_CHARGING), ('launch', FLAG_LAUNCH), ('compact', FLAG_COMPACT)]
+    return ','.join(name for name, flag in names if value & flag) or '-'
+
+
+def main(argv):
+    paths = argv[1:]
+    if any(path.startswith('-') for path in paths):
+        print(USAGE, file=sys.stderr)
+        return 2
+
+    lines = []
+    if paths:
+        for path in paths:
+            with open(path) as f:
+                lines.extend(f)
+    else:
+        lines.extend(sys.stdin)
+    samples = last_dump(lines)
+    if not samples:
+        print('no energy samples found', file=sys.stderr)
+        return 1
+
+    print('%8s %8s %-18s %10s %10s %10s' % ('minutes', 'percent', 'flags', 'minutes s', 'seconds s', 'sweep s'))
+    for sample in samples:
+        t = mode_seconds(sample)
+        print('%8d %+8d %-18s %10d %10d %10d' % (sample[0], sample[1], flags(sample[2]), t[0], t[1], t[2]))
+    print()
+
+    rates, observed = drain(samples)
+    print('%-8s %10s %10s' % ('mode', '%/h', 'observed h'))
+    for m, name in enumerate(MODES):
+        rate = '-' if rates[m] is None else '%.2f' % rates[m]
+        print('%-8s %10s %10.1f' % (name, rate, observed[m] / 3600.0))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
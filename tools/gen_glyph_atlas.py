@@ -0,0 +1,171 @@
+#!/usr/bin/env python
+#
+# gen_glyph_atlas.py
+#
+# Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+"""Generates circlock_glyph_atlas.h, the bitmap fonts of the labels.
+
+The glyphs are drawn below on a 5x8 grid, rows 0-6 above the baseline and
+row 7 for descenders. The date atlas holds every glyph as drawn, the time
+atlas only what "%I:%M%p" needs at TIME_SCALE. Rows are stored with bit 0
+as the leftmost pixel, the order of a 1-bit Pebble frame buffer.
+"""
+
+from __future__ import print_function
+
+import sys
+
+USAGE = 'usage: gen_glyph_atlas.py [--check] circlock_glyph_atlas.h'
+
+GLYPH_WIDTH = 5
+GLYPH_HEIGHT = 8
+GLYPH_SPACING = 1
+
+TIME_CHARS = '0123456789:AMP'
+TIME_SCALE = 2
+
+GLYPHS = {
+    '0': ['.###.', '#...#', '#..##', '#.#.#', '##..#', '#...#', '.###.'],
+    '1': ['..#..', '.##..', '..#..', '..#..', '..#..', '..#..', '.###.'],
+    '2': ['.###.', '#...#', '....#', '...#.', '..#..', '.#...', '#####'],
+    '3': ['#####', '...#.', '..#..', '...#.', '....#', '#...#', '.###.'],
+    '4': ['...#.', '..##.', '.#.#.', '#..#.', '#####', '...#.', '...#.'],
+    '5': ['#####', '#....', '####.', '....#', '....#', '#...#', '.###.'],
+    '6': ['..##.', '.#...', '#....', '####.', '#...#', '#...#', '.###.'],
+    '7': ['#####', '....#', '...#.', '..#..', '.#...', '.#...', '.#...'],
+    '8': ['.###.', '#...#', '#...#', '.###.', '#...#', '#...#', '.###.'],
+    '9': ['.###.', '#...#', '#...#', '.####', '....#', '...#.', '.##..'],
+    ':': ['.....', '.##..', '.##..', '.....', '.##..', '.##..', '.....'],
+    ',': ['.....', '.....', '.....', '.....', '.....', '.##..', '..#..', '.#...'],
+    'A': ['.###.', '#...#', '#...#', '#####', '#...#', '#...#', '#...#'],
+    'D': ['####.', '#...#', '#...#', '#...#', '#...#', '#...#', '####.'],
+    'F': ['#####', '#....', '#....', '####.', '#....', '#....', '#....'],
+    'J': ['..###', '...#.', '...#.', '...#.', '...#.', '#..#.', '.##..'],
+    'M': ['#...#', '##.##', '#.#.#', '#.#.#', '#...#', '#...#', '#...#'],
+    'N': ['#...#', '#...#', '##..#', '#.#.#', '#..##', '#...#', '#...#'],
+    'O': ['.###.', '#...#', '#...#', '#...#', '#...#', '#...#', '.###.'],
+    'P': ['####.', '#...#', '#...#', '####.', '#....', '#....', '#....'],
+    'S': ['.####', '#....', '#....', '.###.', '....#', '....#', '####.'],
+    'T': ['#####', '..#..', '..#..', '..#..', '..#..', '..#..', '..#..'],
+    'W': ['#...#', '#...#', '#...#', '#.#.#', '#.#.#', '#.#.#', '.#.#.'],
+    'a': ['.....', '.....', '.###.', '....#', '.####', '#...#', '.####'],
+    'b': ['#....', '#....', '#.##.', '##..#', '#...#', '#...#', '####.'],
+    'c': ['.....', '.....', '.###.', '#....', '#....', '#...#', '.###.'],
+    'd': ['....#', '....#', '.##.#', '#..##', '#...#', '#...#', '.####'],
+    'e': ['.....', '.....', '.###.', '#...#', '#####', '#....', '.###.'],
+    'g': ['.....', '.....', '.####', '#...#', '#...#', '.####', '....#', '.###.'],
+    'h': ['#....', '#....', '#.##.', '##..#', '#...#', '#...#', '#...#'],
+    'i': ['..#..', '.....', '.##..', '..#..', '..#..', '..#..', '.###.'],
+    'l': ['.##..', '..#..', '..#..', '..#..', '..#..', '..#..', '.###.'],
+    'n': ['.....', '.....', '#.##.', '##..#', '#...#', '#...#', '#...#'],
+    'o': ['.....', '.....', '.###.', '#...#', '#...#', '#...#', '.###.'],
+    'p': ['.....', '.....', '####.', '#...#', '#...#', '####.', '#....', '#....'],
+    'r': ['.....', '.....', '#.##.', '##..#', '#....', '#....', '#....'],
+    't': ['.#...', '.#...', '###..', '.#...', '.#...', '.#..#', '..##.'],
+    'u': ['.....', '.....', '#...#', '#...#', '#...#', '#..##', '.##.#'],
+    'v': ['.....', '.....', '#...#', '#...#', '#...#', '.#.#.', '..#..'],
+    'y': ['.....', '.....', '#...#', '#...#', '#...#', '.####', '....#', '.###.'],
+}
+
+
+def glyph_rows(char, scale, height):
+    art = GLYPHS[char] + ['.' * GLYPH_WIDTH] * (GLYPH_HEIGHT - len(GLYPHS[char]))
+    if len(art) != GLYPH_HEIGHT or any(len(row) != GLYPH_WIDTH for row in art):
+        raise ValueError('glyph %r is not %dx%d' % (char, GLYPH_WIDTH, GLYPH_HEIGHT))
+    rows = []
+    for row in art[:height // scale]:
+        bits = 0
+        for x, pixel in enumerate(row):
+            if pixel == '#':
+                for dx in range(scale):
+                    bits |= 1 << (x * scale + dx)
+        rows.extend([bits] * scale)
+    return rows
+
+
+def atlas(name, chars, scale, height):
+    width = GLYPH_WIDTH * scale
+    if width > 16:
+        raise ValueError('%s glyphs do not fit into uint16_t rows' % name.lower())
+    index = [-1] * 96
+    for i, char in enumerate(chars):
+        index[ord(char) - 32] = i
+    lines = [
+        '',
+        '#define CIRCLOCK_GLYPH_%s_WIDTH %d' % (name, width),
+        '#define CIRCLOCK_GLYPH_%s_HEIGHT %d' % (name, height),
+        '#define CIRCLOCK_GLYPH_%s_ADVANCE %d' % (name, width + GLYPH_SPACING * scale),
+        '',
+        '// glyph of every character from \' \', -1 when there is none',
+        'static const int8_t %s_GLYPH_INDEX[96] = {' % name,
+    ]
+    for i in range(0, 96, 16):
+        lines.append('    %s,' % ', '.join('%d' % n for n in index[i:i + 16]))
+    lines.append('};')
+    lines.append('')
+    lines.append('static const uint16_t %s_GLYPHS[%d][CIRCLOCK_GLYPH_%s_HEIGHT] = {' % (name, len(chars), name))
+    for char in chars:
+        rows = glyph_rows(char, scale, height)
+        lines.append('    {%s}, // %s' % (', '.join('0x%04x' % r for r in rows), char))
+    lines.append('};')
+    return lines
+
+
+def generate():
+    date_chars = ''.join(sorted(GLYPHS))
+    # the time never descends below the baseline
+    time_height = (GLYPH_HEIGHT - 1) * TIME_SCALE
+    lines = [
+        '// circlock_glyph_atlas.h',
+        '//',
+        '// Generated by tools/gen_glyph_atlas.py, do not edit.',
+        '',
+        '#pragma once',
+        '',
+        '#include <pebble.h>',
+    ]
+    lines.extend(atlas('TIME', TIME_CHARS, TIME_SCALE, time_height))
+    lines.extend(atlas('DATE', date_chars, 1, GLYPH_HEIGHT))
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    check = len(argv) > 1 and argv[1] == '--check'
+    args = argv[2:] if check else argv[1:]
+    if len(args) != 1:
+        print(USAGE, file=sys.stderr)
+        return 2
+    output = generate()
+    if check:
+        with open(args[0]) as f:
+            if f.read() != output:
+                print('%s is out of date' % args[0], file=sys.stderr)
+                return 1
+        return 0
+    with open(args[0], 'w') as f:
+        f.write(output)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
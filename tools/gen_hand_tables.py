@@ -0,0 +1,275 @@
+#!/usr/bin/env python
+#
+# gen_hand_tables.py
+#
+# Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+"""Generates circlock_hands_table.h from the CIRCLOCK_* macros.
+
+Every hand position is rotated the way gpath_rotate_to() and
+gpath_draw_filled() transform a path, with the integer sine table of
+gen_trig_table.py, so the watch only has to index the tables. Points are
+stored relative to the clock center. The -D options set macros the way the
+compiler command line of a build variant does.
+"""
+
+from __future__ import print_function
+
+import ast
+import math
+import operator
+import re
+import sys
+
+from gen_trig_table import TRIG_MAX_ANGLE, TRIG_MAX_RATIO, cos_lookup, sin_lookup
+
+USAGE = 'usage: gen_hand_tables.py [--check] [-DNAME=VALUE ...] circlock_conf.h circlock_hands_table.h'
+
+# python 2 has no ast.Constant
+NUMBER_NODE = getattr(ast, 'Constant', None) or ast.Num
+
+DEFINE_RE = re.compile(r'^\s*#\s*define\s+(\w+)\s+(.+?)\s*(//.*)?$')
+CONDITION_RE = re.compile(r'^\s*#\s*(if|ifdef|ifndef|else|endif)\b\s*(.*?)\s*(//.*)?$')
+RING_TABLE_RE = re.compile(r'^\s*#\s*define\s+CIRCLOCK_RING_TABLE\(\w+\)(.*)$')
+RING_RE = re.compile(r'\w+\(\s*(\w+)\s*,\s*([^)]+?)\s*\)')
+
+
+def c_div(a, b):
+    # C integer division truncates toward zero
+    q = abs(a) // abs(b)
+    return q if (a < 0) == (b < 0) else -q
+
+
+BINARY_OPS = {
+    ast.Add: operator.add,
+    ast.Sub: operator.sub,
+    ast.Mult: operator.mul,
+    ast.Div: c_div,
+}
+
+COMPARE_OPS = {
+    ast.Eq: operator.eq,
+    ast.NotEq: operator.ne,
+    ast.Lt: operator.lt,
+    ast.LtE: operator.le,
+    ast.Gt: operator.gt,
+    ast.GtE: operator.ge,
+}
+
+
+def read_conf(path, overrides):
+    # the lines the preprocessor keeps, continuations joined, and the macros
+    # they define on top of the overrides
+    defines = dict(overrides)
+    lines = []
+    # whether every enclosing #if holds, and whether this one held
+    stack = []
+    with open(path) as f:
+        text = f.read().replace('\\\n', ' ')
+    for line in text.split('\n'):
+        match = CONDITION_RE.match(line)
+        active = all(held for held, taken in stack)
+        if match:
+            directive, argument = match.group(1), match.group(2)
+            if directive == 'endif':
+                stack.pop()
+            elif directive == 'else':
+                held, taken = stack.pop()
+                stack.append((not taken, True))
+            else:
+                if directive == 'ifdef':
+                    held = argument in defines
+                elif directive == 'ifndef':
+                    held = argument not in defines
+                else:
+                    held = active and bool(evaluate_expression(defines, argument, '#if', undefined=0))
+                stack.append((held, held))
+            continue
+        if not active:
+            continue
+        lines.append(line)
+        match = DEFINE_RE.match(line)
+        if match:
+            defines[match.group(1)] = match.group(2)
+    return defines, lines
+
+
+def evaluate(defines, name, seen=()):
+    if name in seen:
+        raise ValueError('recursive macro %s' % name)
+    return evaluate_expression(defines, defines[name], name, seen)
+
+
+def evaluate_expression(defines, expression, name, seen=(), undefined=None):
+    # C operators spelled the python way, ! but not !=
+    expression = expression.replace('&&', ' and ').replace('||', ' or ')
+    expression = re.sub(r'!(?!=)', ' not ', expression)
+    tree = ast.parse(expression.strip(), mode='eval')
+
+    def visit(node):
+        if isinstance(node, ast.Expression):
+            return visit(node.body)
+        if isinstance(node, ast.BinOp) and type(node.op) in BINARY_OPS:
+            return BINARY_OPS[type(node.op)](visit(node.left), visit(node.right))
+        if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.USub):
+            return -visit(node.operand)
+        if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.Not):
+            return int(not visit(node.operand))
+        if isinstance(node, ast.BoolOp):
+            values = [visit(value) for value in node.values]
+            return int(all(values) if isinstance(node.op, ast.And) else any(values))
+        if isinstance(node, ast.Compare) and len(node.ops) == 1 and type(node.ops[0]) in COMPARE_OPS:
+            return int(COMPARE_OPS[type(node.ops[0])](visit(node.left), visit(node.comparators[0])))
+        if isinstance(node, ast.Name):
+            if node.id not in defines and undefined is not None:
+                return undefined
+            return evaluate(defines, node.id, seen + (name,))
+        if isinstance(node, NUMBER_NODE):
+            return int(node.value if hasattr(node, 'value') else node.n)
+        raise ValueError('unsupported expression in %s' % name)
+
+    return visit(tree)
+
+
+def rotate(points, angle):
+    sine, cosine = sin_lookup(angle), cos_lookup(angle)
+    return [(c_div(x * cosine, TRIG_MAX_RATIO) - c_div(y * sine, TRIG_MAX_RATIO),
+             c_div(y * cosine, TRIG_MAX_RATIO) + c_div(x * sine, TRIG_MAX_RATIO))
+            for x, y in points]
+
+
+def isqrt(n):
+    root = int(math.sqrt(n))
+    while root * root > n:
+        root -= 1
+    while (root + 1) * (root + 1) <= n:
+        root += 1
+    return root
+
+
+def ring_rows(inner, outer, rows):
+    # per row distance from the center: the widest x still inside the hole
+    # (-1 below it) and the widest x inside the outer circle (-1 past it)
+    extents = []
+    for dy in range(rows):
+        hole = isqrt(inner * inner - dy * dy - 1) if dy < inner else -1
+        edge = isqrt(outer * outer - dy * dy) if dy <= outer else -1
+        extents.append((hole, edge))
+    return extents
+
+
+def read_rings(lines, defines):
+    # the (unit, steps) entries of CIRCLOCK_RING_TABLE, from the outside in
+    for line in lines:
+        match = RING_TABLE_RE.match(line)
+        if match:
+            return [(unit, evaluate_expression(defines, steps, 'CIRCLOCK_RING_TABLE'))
+                    for unit, steps in RING_RE.findall(match.group(1))]
+    raise ValueError('no CIRCLOCK_RING_TABLE in circlock_conf.h')
+
+
+def hand_points(width, inner, outer):
+    return [(c_div(-width, 2), outer),
+            (c_div(width, 2), outer),
+            (c_div(width, 2), inner),
+            (c_div(-width, 2), inner)]
+
+
+def generate(conf_path, overrides):
+    defines, conf_lines = read_conf(conf_path, overrides)
+    radius = evaluate(defines, 'CIRCLOCK_CLOCK_RADIUS')
+    width = evaluate(defines, 'CIRCLOCK_HAND_WIDTH')
+    height = evaluate(defines, 'CIRCLOCK_HAND_HEIGHT')
+    margin = evaluate(defines, 'CIRCLOCK_HAND_MARGIN')
+
+    rings = read_rings(conf_lines, defines)
+
+    # the rings the hands are cut out of, as radii of the hand ends
+    radii = []
+    for index in range(len(rings)):
+        point_y = radius + margin - index * (height + margin)
+        radii.append((point_y - height - margin, point_y + margin))
+    ring_rows_count = max(outer for inner, outer in radii) + 1
+
+    lines = [
+        '// circlock_hands_table.h',
+        '//',
+        '// Generated by tools/gen_hand_tables.py from circlock_conf.h, do not edit.',
+        '',
+        '#pragma once',
+        '',
+        '#include <pebble.h>',
+        '',
+        '#define CIRCLOCK_HAND_TABLE_POINTS 4',
+        '#define CIRCLOCK_HAND_TABLE_RINGS %d' % len(rings),
+        '#define CIRCLOCK_HAND_TABLE_STEPS %d' % sum(steps for unit, steps in rings),
+        '',
+        '// the positions of every ring in turn, from the outside in',
+        'static const int8_t HAND_TABLE[CIRCLOCK_HAND_TABLE_STEPS][CIRCLOCK_HAND_TABLE_POINTS][2] = {',
+    ]
+    for (unit, steps), (inner, outer) in zip(rings, radii):
+        points = hand_points(width, inner, outer)
+        lines.append('    // %s, %d steps' % (unit.lower(), steps))
+        for step in range(steps):
+            rotated = rotate(points, c_div(TRIG_MAX_ANGLE * step, steps) + TRIG_MAX_ANGLE // 2)
+            for x, y in rotated:
+                if not (-128 <= x <= 127 and -128 <= y <= 127):
+                    raise ValueError('%s hand does not fit into int8_t' % unit.lower())
+            lines.append('    {%s},' % ', '.join('{%d, %d}' % p for p in rotated))
+    lines.append('};')
+
+    lines.append('')
+    lines.append('#define CIRCLOCK_RING_ROWS %d' % ring_rows_count)
+    lines.append('')
+    lines.append('static const int8_t RING_ROW_EXTENTS[%d][CIRCLOCK_RING_ROWS][2] = {' % len(radii))
+    for inner, outer in radii:
+        extents = ring_rows(inner, outer, ring_rows_count)
+        lines.append('    {')
+        for i in range(0, len(extents), 8):
+            lines.append('        %s,' % ', '.join('{%d, %d}' % e for e in extents[i:i + 8]))
+        lines.append('    },')
+    lines.append('};')
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    check = len(argv) > 1 and argv[1] == '--check'
+    args = argv[2:] if check else argv[1:]
+    overrides = dict((arg[2:].partition('=')[0], arg[2:].partition('=')[2] or '1')
+                     for arg in args if arg.startswith('-D'))
+    args = [arg for arg in args if not arg.startswith('-D')]
+    if len(args) != 2:
+        print(USAGE, file=sys.stderr)
+        return 2
+    output = generate(args[0], overrides)
+    if check:
+        with open(args[1]) as f:
+            if f.read() != output:
+                print('%s is out of date with %s' % (args[1], args[0]), file=sys.stderr)
+                return 1
+        return 0
+    with open(args[1], 'w') as f:
+        f.write(output)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+#
+# gen_trig_table.py
+#
+# Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+"""Generates pebble_trig_table.h, the sine table of the host stand-in SDK.
+
+sin_lookup() and cos_lookup() of the firmware look the first quadrant up in
+an integer table and fold every other angle onto it, so the sine of an angle
+and of its mirror images are the same integer. gen_hand_tables.py rotates
+the hands with the functions below and the stand-in SDK reads the table
+this writes, so tables and runtime rotation agree to the last bit.
+"""
+
+from __future__ import print_function
+
+import math
+import sys
+
+USAGE = 'usage: gen_trig_table.py pebble_trig_table.h'
+
+TRIG_MAX_RATIO = 0xffff
+TRIG_MAX_ANGLE = 0x10000
+QUARTER = TRIG_MAX_ANGLE // 4
+
+
+def quarter_table():
+    # rounded half up the same way on python 2 and 3
+    return [int(math.floor(math.sin(2.0 * math.pi * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO + 0.5))
+            for angle in range(QUARTER + 1)]
+
+
+SIN_QUARTER = quarter_table()
+
+
+def sin_lookup(angle):
+    sign = 1
+    if angle < 0:
+        angle = -angle
+        sign = -sign
+    angle %= TRIG_MAX_ANGLE
+    if angle >= TRIG_MAX_ANGLE // 2:
+        angle -= TRIG_MAX_ANGLE // 2
+        sign = -sign
+    if angle > QUARTER:
+        angle = TRIG_MAX_ANGLE // 2 - angle
+    return sign * SIN_QUARTER[angle]
+
+
+def cos_lookup(angle):
+    return sin_lookup(angle + QUARTER)
+
+
+def generate():
+    lines = [
+        '// pebble_trig_table.h',
+        '//',
+        '// Generated by tools/gen_trig_table.py, do not edit.',
+        '',
+        '#pragma once',
+        '',
+        '#include <stdint.h>',
+        '',
+        '// sine of every angle of the first quadrant, 0 to TRIG_MAX_ANGLE / 4',
+        'static const uint16_t SIN_QUARTER[%d] = {' % len(SIN_QUARTER),
+    ]
+    for i in range(0, len(SIN_QUARTER), 12):
+        lines.append('    %s,' % ', '.join('%d' % value for value in SIN_QUARTER[i:i + 12]))
+    lines.append('};')
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    if len(argv) != 2:
+        print(USAGE, file=sys.stderr)
+        return 2
+    with open(argv[1], 'w') as f:
+        f.write(generate())
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+#
+# trace_report.py
+#
+# Copyright (c) 2014 Shintaro Kaneko (http://kaneshinth.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+"""Summarizes circlock frame-time traces per layer.
+
+Reads `pebble logs` output containing the "trace:" lines written by
+circlock_trace.c, or with --binary the raw 8-byte samples received through
+DataLogging, and prints sample counts and duration percentiles for every
+layer and for every trigger.
+"""
+
+from __future__ import print_function
+
+import binascii
+import math
+import re
+import struct
+import sys
+
+USAGE = 'usage: trace_report.py [--binary] [FILE...]'
+
+# matches CirclockTraceSample in src/circlock_trace.h
+SAMPLE = struct.Struct('<BBHI')
+
+LAYERS = ['bg', 'hands', 'battery', 'labels', 'snapshot']
+TRIGGERS = ['none', 'load', 'second tick', 'minute tick', 'battery', 'focus', 'resolution', 'charging', 'sweep']
+
+TRACE_RE = re.compile(r'trace:([0-9a-f]+)')
+
+
+def name(names, index):
+    return names[index] if index < len(names) else str(index)
+
+
+def samples_from_log(lines):
+    for line in lines:
+        match = TRACE_RE.search(line)
+        if not match:
+            continue
+        data = binascii.unhexlify(match.group(1))
+        for offset in range(0, len(data) - SAMPLE.size + 1, SAMPLE.size):
+            yield SAMPLE.unpack_from(data, offset)
+
+
+def samples_from_binary(data):
+    for offset in range(0, len(data) - SAMPLE.size + 1, SAMPLE.size):
+        yield SAMPLE.unpack_from(data, offset)
+
+
+def percentile(sorted_values, fraction):
+    # nearest rank
+    rank = max(1, int(math.ceil(fraction * len(sorted_values))))
+    return sorted_values[rank - 1]
+
+
+def report(title, names, groups):
+    print('%-12s %8s %6s %6s %6s %6s %8s' % (title, 'samples', 'p50', 'p90', 'p99', 'max', 'total'))
+    for key in sorted(groups):
+        durations = sorted(groups[key])
+        print('%-12s %8d %6d %6d %6d %6d %8d' % (
+            name(names, key), len(durations),
+            percentile(durations, 0.50), percentile(durations, 0.90),
+            percentile(durations, 0.99), durations[-1], sum(durations)))
+
+
+def main(argv):
+    binary = '--binary' in argv[1:]
+    paths = [arg for arg in argv[1:] if arg != '--binary']
+    if any(path.startswith('-') for path in paths):
+        print(USAGE, file=sys.stderr)
+        return 2
+
+    samples = []
+    if binary:
+        for path in paths:
+            with open(path, 'rb') as f:
+                samples.extend(samples_from_binary(f.read()))
+    elif paths:
+        for path in paths:
+            with open(path) as f:
+                samples.extend(samples_from_log(f))
+    else:
+        samples.extend(samples_from_log(sys.stdin))
+
+    if not samples:
+        print('no trace samples found', file=sys.stderr)
+        return 1
+
+    by_layer = {}
+    by_trigger = {}
+    for layer, trigger, duration, start in samples:
+        by_layer.setdefault(layer, []).append(duration)
+        by_trigger.setdefault(trigger, []).append(duration)
+
+    # time_ms() deltas, 0 is anything that finished within a millisecond
+    print('durations in whole ms, %d samples over %.1f s' % (
+        len(samples), (max(s[3] for s in samples) - min(s[3] for s in samples)) / 1000.0))
+    print()
+    report('layer', LAYERS, by_layer)
+    print()
+    report('trigger', TRIGGERS, by_trigger)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))